@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include "../ut/fake_server.h"
+
+#include <clickhouse/base/coded.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/client.h>
+
+#include <algorithm>
+
+namespace clickhouse {
+
+static const int kFakeServerPort = 19100;
+static const size_t kBlocks = 16;
+
+/// Server and clients are created on first use and live until exit,
+/// so connection setup is not measured.
+static FakeServer& GetFakeServer() {
+    static FakeServer server(kFakeServerPort);
+    return server;
+}
+
+static Client& GetFakeClient(CompressionMethod method = CompressionMethod::None) {
+    GetFakeServer();
+
+    static auto make = [] (CompressionMethod method) {
+        return ClientOptions()
+            .SetHost("localhost")
+            .SetPort(kFakeServerPort)
+            .SetPingBeforeQuery(false)
+            .SetCompressionMethod(method);
+    };
+    static Client plain(make(CompressionMethod::None));
+    static Client lz4(make(CompressionMethod::LZ4));
+    static Client zstd(make(CompressionMethod::ZSTD));
+
+    switch (method) {
+    case CompressionMethod::LZ4:
+        return lz4;
+    case CompressionMethod::ZSTD:
+        return zstd;
+    default:
+        return plain;
+    }
+}
+
+/// Size of serialized columns of the block.
+static size_t BlockBytes(const Block& block) {
+    Buffer buf;
+    BufferOutput output(&buf);
+    CodedOutputStream coded(&output);
+
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        bi.Column()->Save(&coded);
+    }
+    coded.Flush();
+
+    return buf.size();
+}
+
+static void LocalSelect(benchmark::State& state, const std::string& type, CompressionMethod method) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({type, type, type}, state.range(0));
+    script.blocks = kBlocks;
+    GetFakeServer().SetScript(script);
+
+    size_t rows = 0;
+    while (state.KeepRunning()) {
+        GetFakeClient(method).Select("SELECT c0, c1, c2 FROM fake",
+            [&rows](const Block& b) { rows += b.GetRowCount(); }
+        );
+    }
+
+    state.SetItemsProcessed(rows);
+    state.SetBytesProcessed(state.iterations() * kBlocks * BlockBytes(script.block));
+}
+BENCHMARK_CAPTURE(LocalSelect, UInt64, "UInt64", CompressionMethod::None)->Arg(1)->Arg(1024)->Arg(65536);
+BENCHMARK_CAPTURE(LocalSelect, String, "String", CompressionMethod::None)->Arg(1024)->Arg(65536);
+BENCHMARK_CAPTURE(LocalSelect, Nullable, "Nullable(Float64)", CompressionMethod::None)->Arg(65536);
+BENCHMARK_CAPTURE(LocalSelect, Array, "Array(UInt32)", CompressionMethod::None)->Arg(65536);
+BENCHMARK_CAPTURE(LocalSelect, StringLZ4, "String", CompressionMethod::LZ4)->Arg(65536);
+BENCHMARK_CAPTURE(LocalSelect, StringZSTD, "String", CompressionMethod::ZSTD)->Arg(65536);
+
+static void LocalInsert(benchmark::State& state, const std::string& type, CompressionMethod method) {
+    const Block block = MakeSyntheticBlock({type, type, type}, state.range(0));
+
+    while (state.KeepRunning()) {
+        GetFakeClient(method).Insert("fake", block);
+    }
+
+    state.SetItemsProcessed(state.iterations() * block.GetRowCount());
+    state.SetBytesProcessed(state.iterations() * BlockBytes(block));
+}
+BENCHMARK_CAPTURE(LocalInsert, UInt64, "UInt64", CompressionMethod::None)->Arg(1)->Arg(1024)->Arg(65536);
+BENCHMARK_CAPTURE(LocalInsert, String, "String", CompressionMethod::None)->Arg(1024)->Arg(65536);
+BENCHMARK_CAPTURE(LocalInsert, StringLZ4, "String", CompressionMethod::LZ4)->Arg(65536);
+
+static void LocalInsertNoDelay(benchmark::State& state) {
+    GetFakeServer();
+
+    static Client client(ClientOptions()
+        .SetHost("localhost")
+        .SetPort(kFakeServerPort)
+        .SetPingBeforeQuery(false)
+        .TcpNoDelay(true));
+    const Block block = MakeSyntheticBlock({"UInt64", "UInt64", "UInt64"}, state.range(0));
+
+    while (state.KeepRunning()) {
+        client.Insert("fake", block);
+    }
+
+    state.SetItemsProcessed(state.iterations() * block.GetRowCount());
+    state.SetBytesProcessed(state.iterations() * BlockBytes(block));
+}
+BENCHMARK(LocalInsertNoDelay)->Arg(1)->Arg(1024);
+
+static void LocalSelectLatency(benchmark::State& state) {
+    // The server answers after a millisecond and streams a block every
+    // 100 microseconds; counters show the tail of query durations.
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64", "String"}, 1024);
+    script.blocks = kBlocks;
+    script.latency = std::chrono::milliseconds(1);
+    script.interval = std::chrono::microseconds(100);
+    GetFakeServer().SetScript(script);
+
+    std::vector<double> durations;
+    while (state.KeepRunning()) {
+        const auto start = std::chrono::steady_clock::now();
+
+        GetFakeClient().Select("SELECT c0, c1 FROM fake", [](const Block&) {});
+        durations.push_back(std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(durations.begin(), durations.end());
+    state.counters["p50_us"] = durations[durations.size() / 2];
+    state.counters["p99_us"] = durations[durations.size() * 99 / 100];
+    state.counters["max_us"] = durations.back();
+    state.SetItemsProcessed(state.iterations() * kBlocks * script.block.GetRowCount());
+}
+BENCHMARK(LocalSelectLatency)->UseRealTime();
+
+}
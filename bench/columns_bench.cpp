@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include "../ut/fake_server.h"
+
+#include <clickhouse/base/coded.h>
+#include <clickhouse/base/input.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/columns/factory.h>
+
+namespace clickhouse {
+
+static const size_t kRows = 65536;
+
+static Buffer SaveColumn(const ColumnRef& col) {
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+    }
+    return buf;
+}
+
+static void ColumnSave(benchmark::State& state, const std::string& type) {
+    const ColumnRef col = MakeSyntheticColumn(type, kRows);
+    Buffer buf;
+
+    while (state.KeepRunning()) {
+        buf.clear();
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+
+        col->Save(&coded);
+        coded.Flush();
+    }
+
+    state.SetItemsProcessed(state.iterations() * kRows);
+    state.SetBytesProcessed(state.iterations() * SaveColumn(col).size());
+}
+
+static void ColumnLoad(benchmark::State& state, const std::string& type) {
+    const Buffer buf = SaveColumn(MakeSyntheticColumn(type, kRows));
+    const ColumnRef col = CreateColumnByType(type);
+
+    while (state.KeepRunning()) {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+
+        col->Clear();
+        if (!col->Load(&coded, kRows)) {
+            state.SkipWithError("can't load column");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * kRows);
+    state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+BENCHMARK_CAPTURE(ColumnSave, UInt8, "UInt8");
+BENCHMARK_CAPTURE(ColumnSave, UInt64, "UInt64");
+BENCHMARK_CAPTURE(ColumnSave, Float64, "Float64");
+BENCHMARK_CAPTURE(ColumnSave, DateTime, "DateTime");
+BENCHMARK_CAPTURE(ColumnSave, String, "String");
+BENCHMARK_CAPTURE(ColumnSave, FixedString, "FixedString(16)");
+BENCHMARK_CAPTURE(ColumnSave, Nullable, "Nullable(UInt64)");
+BENCHMARK_CAPTURE(ColumnSave, Array, "Array(UInt64)");
+BENCHMARK_CAPTURE(ColumnSave, ArrayOfStrings, "Array(String)");
+
+BENCHMARK_CAPTURE(ColumnLoad, UInt8, "UInt8");
+BENCHMARK_CAPTURE(ColumnLoad, UInt64, "UInt64");
+BENCHMARK_CAPTURE(ColumnLoad, Float64, "Float64");
+BENCHMARK_CAPTURE(ColumnLoad, DateTime, "DateTime");
+BENCHMARK_CAPTURE(ColumnLoad, String, "String");
+BENCHMARK_CAPTURE(ColumnLoad, FixedString, "FixedString(16)");
+BENCHMARK_CAPTURE(ColumnLoad, Nullable, "Nullable(UInt64)");
+BENCHMARK_CAPTURE(ColumnLoad, Array, "Array(UInt64)");
+BENCHMARK_CAPTURE(ColumnLoad, ArrayOfStrings, "Array(String)");
+
+}
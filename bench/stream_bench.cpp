@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+
+#include "../ut/fake_server.h"
+
+#include <clickhouse/base/coded.h>
+#include <clickhouse/base/compressed.h>
+#include <clickhouse/base/input.h>
+#include <clickhouse/base/output.h>
+
+#include <memory>
+
+namespace clickhouse {
+
+static void VarintEncode(benchmark::State& state) {
+    // Values spread over all lengths of encoding, from 1 to 10 bytes.
+    std::vector<uint64_t> values(4096);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = uint64_t(1) << (i % 64);
+    }
+
+    Buffer buf(values.size() * 10);
+
+    while (state.KeepRunning()) {
+        ArrayOutput output(buf.data(), buf.size());
+        CodedOutputStream coded(&output);
+
+        for (const uint64_t value : values) {
+            coded.WriteVarint64(value);
+        }
+        coded.Flush();
+    }
+
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(VarintEncode);
+
+static void VarintDecode(benchmark::State& state) {
+    const size_t count = 4096;
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        for (size_t i = 0; i < count; ++i) {
+            coded.WriteVarint64(uint64_t(1) << (i % 64));
+        }
+    }
+
+    while (state.KeepRunning()) {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        uint64_t value;
+
+        for (size_t i = 0; i < count; ++i) {
+            coded.ReadVarint64(&value);
+        }
+        benchmark::DoNotOptimize(value);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * buf.size());
+}
+BENCHMARK(VarintDecode);
+
+/// Serialized columns of a typical result, which compress like real data.
+static Buffer MakeCompressibleData() {
+    Buffer buf;
+    BufferOutput output(&buf);
+    CodedOutputStream coded(&output);
+
+    MakeSyntheticColumn("UInt64", 1 << 18)->Save(&coded);
+    MakeSyntheticColumn("String", 1 << 18)->Save(&coded);
+    MakeSyntheticColumn("Nullable(Float64)", 1 << 18)->Save(&coded);
+    coded.Flush();
+
+    return buf;
+}
+
+static void Compress(benchmark::State& state, int method) {
+    const Buffer data = MakeCompressibleData();
+    Buffer buf;
+
+    while (state.KeepRunning()) {
+        buf.clear();
+        BufferOutput output(&buf);
+        CompressedOutput compressed(&output, method);
+
+        compressed.Write(data.data(), data.size());
+        compressed.Flush();
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["ratio"] = double(data.size()) / buf.size();
+}
+BENCHMARK_CAPTURE(Compress, LZ4, int(CompressionMethodByte::LZ4));
+BENCHMARK_CAPTURE(Compress, ZSTD, int(CompressionMethodByte::ZSTD));
+
+static void Decompress(benchmark::State& state, int method) {
+    const Buffer data = MakeCompressibleData();
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CompressedOutput compressed(&output, method);
+
+        compressed.Write(data.data(), data.size());
+        compressed.Flush();
+    }
+
+    Buffer result(data.size());
+
+    while (state.KeepRunning()) {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        CompressedInput compressed(&coded);
+        CodedInputStream decompressed(&compressed);
+
+        if (!decompressed.ReadRaw(result.data(), result.size())) {
+            state.SkipWithError("can't decompress data");
+            break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK_CAPTURE(Decompress, LZ4, int(CompressionMethodByte::LZ4));
+BENCHMARK_CAPTURE(Decompress, ZSTD, int(CompressionMethodByte::ZSTD));
+
+}
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <clickhouse/columns/factory.h>
+#include <clickhouse/types/type_parser.h>
+
+namespace clickhouse {
+
+static const std::string kTypeNames[] = {
+    "UInt64",
+    "String",
+    "Nullable(Float64)",
+    "Array(Nullable(String))",
+    "DateTime('Europe/Moscow')",
+    "Tuple(UInt8, Array(Nullable(Int32)), FixedString(16))",
+};
+
+static void ParseTypeNameUncached(benchmark::State& state) {
+    size_t i = 0;
+    size_t bytes = 0;
+
+    while (state.KeepRunning()) {
+        const std::string& name = kTypeNames[i++ % 6];
+        TypeAst ast;
+
+        benchmark::DoNotOptimize(TypeParser(name).Parse(&ast));
+        bytes += name.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(ParseTypeNameUncached);
+
+static void ParseTypeNameCached(benchmark::State& state) {
+    // Lookup of already parsed types from many threads at once.
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ParseTypeName(kTypeNames[i++ % 6]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(ParseTypeNameCached)->ThreadRange(1, 32);
+
+static void CreateColumnByTypeName(benchmark::State& state) {
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(CreateColumnByType(kTypeNames[i++ % 6]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CreateColumnByTypeName);
+
+}
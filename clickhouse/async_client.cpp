@@ -0,0 +1,457 @@
+#include "async_client.h"
+
+#if defined(_unix_)
+
+#include "base/socket.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace clickhouse {
+
+class AsyncClient::Impl {
+public:
+     Impl(const ClientOptions& opts, size_t connections);
+    ~Impl();
+
+    /// Queues a query.
+    std::future<void> Execute(Query query);
+
+    /// Queues an insertion of the block.
+    std::future<void> Insert(const std::string& table_name, const Block& block);
+
+private:
+    struct Task {
+        Query query;
+        /// Whether the task is an insertion of the block into the table.
+        bool insert = false;
+        std::string table_name;
+        Block block;
+        std::promise<void> promise;
+    };
+
+    struct Connection {
+        std::unique_ptr<Client> client;
+        std::unique_ptr<Task> task;
+        /// The socket is not watched, the connection has to be reset
+        /// before the next task.
+        bool broken = false;
+        /// The socket is watched for the ability to send data.
+        bool writing = false;
+        /// The connection is being reset by the reset thread.
+        bool resetting = false;
+    };
+
+    /// Result of a reset of a connection.
+    struct Reset {
+        Connection* conn;
+        std::exception_ptr error;
+    };
+
+    std::future<void> Enqueue(std::unique_ptr<Task> task);
+
+    /// Body of the event loop thread.
+    void Loop() noexcept;
+
+    /// Body of the thread resetting broken connections one by one, since
+    /// connecting and the handshake block.
+    void ResetLoop() noexcept;
+
+    /// Waits for events and handles them until stopped.
+    void Run();
+
+    /// Starts queued tasks on idle connections.
+    void Dispatch();
+
+    /// Starts the current task of the connection.
+    void Start(Connection* conn);
+
+    /// Handles the socket of the connection becoming readable or writable.
+    void Receive(Connection* conn);
+    void Send(Connection* conn);
+
+    /// Watches the socket for writing while sent data remains.
+    void UpdateWrite(Connection* conn);
+
+    /// Reports result of the current task of the connection.
+    void Complete(Connection* conn, std::exception_ptr error);
+
+    /// Fails all tasks when the event loop can't continue.
+    void Fail(std::exception_ptr error) noexcept;
+
+    /// Stops watching a connection which is in unknown state.
+    void MarkBroken(Connection* conn) noexcept;
+
+    /// Queues reset of the connection to the reset thread.
+    void Reconnect(Connection* conn);
+
+    /// Watches the connection again after a finished reset.
+    void Reconnected(const Reset& reset);
+
+    /// Interrupts waiting for events in the event loop.
+    void Wakeup() noexcept;
+
+private:
+    std::vector<Connection> connections_;
+    std::unordered_map<int, Connection*> sockets_;
+    SocketPoller poller_;
+    int wakeup_[2];
+
+    std::mutex mutex_;
+    std::deque<std::unique_ptr<Task>> queue_;
+    bool stopped_ = false;
+    /// Error which has stopped the event loop.
+    std::exception_ptr error_;
+
+    /// Connections to be reset, and finished resets.
+    std::deque<Connection*> resets_;
+    std::vector<Reset> reset_done_;
+    std::condition_variable reset_cond_;
+
+    std::thread loop_;
+    std::thread reset_thread_;
+};
+
+AsyncClient::Impl::Impl(const ClientOptions& opts, size_t connections)
+    : connections_(std::max<size_t>(connections, 1))
+{
+    for (auto& conn : connections_) {
+        conn.client.reset(new Client(opts));
+        poller_.Add(conn.client->GetSocket());
+        sockets_[conn.client->GetSocket()] = &conn;
+    }
+
+    if (pipe(wakeup_) != 0) {
+        throw std::system_error(errno, std::system_category(), "fail to create pipe");
+    }
+    // A full pipe already guarantees a wakeup, so writing to it never blocks.
+    fcntl(wakeup_[0], F_SETFL, fcntl(wakeup_[0], F_GETFL) | O_NONBLOCK);
+    fcntl(wakeup_[1], F_SETFL, fcntl(wakeup_[1], F_GETFL) | O_NONBLOCK);
+    poller_.Add(wakeup_[0]);
+
+    loop_ = std::thread([this] () { Loop(); });
+    reset_thread_ = std::thread([this] () { ResetLoop(); });
+}
+
+AsyncClient::Impl::~Impl() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopped_ = true;
+    }
+
+    Wakeup();
+    reset_cond_.notify_all();
+
+    loop_.join();
+    // A reset in progress refers to a connection, so it is waited for.
+    reset_thread_.join();
+
+    close(wakeup_[0]);
+    close(wakeup_[1]);
+}
+
+std::future<void> AsyncClient::Impl::Execute(Query query) {
+    std::unique_ptr<Task> task(new Task);
+    task->query = std::move(query);
+
+    return Enqueue(std::move(task));
+}
+
+std::future<void> AsyncClient::Impl::Insert(const std::string& table_name, const Block& block) {
+    std::unique_ptr<Task> task(new Task);
+    task->insert = true;
+    task->table_name = table_name;
+    task->block = block;
+
+    return Enqueue(std::move(task));
+}
+
+std::future<void> AsyncClient::Impl::Enqueue(std::unique_ptr<Task> task) {
+    std::future<void> result = task->promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (error_) {
+            task->promise.set_exception(error_);
+            return result;
+        }
+        queue_.push_back(std::move(task));
+    }
+
+    Wakeup();
+
+    return result;
+}
+
+void AsyncClient::Impl::Loop() noexcept {
+    try {
+        Run();
+    } catch (...) {
+        Fail(std::current_exception());
+    }
+}
+
+void AsyncClient::Impl::ResetLoop() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        reset_cond_.wait(lock, [this] () { return stopped_ || !resets_.empty(); });
+
+        if (stopped_) {
+            break;
+        }
+
+        Reset reset{resets_.front(), nullptr};
+        resets_.pop_front();
+
+        lock.unlock();
+
+        try {
+            reset.conn->client->ResetConnection();
+        } catch (...) {
+            reset.error = std::current_exception();
+        }
+
+        lock.lock();
+        reset_done_.push_back(reset);
+        Wakeup();
+    }
+}
+
+void AsyncClient::Impl::Run() {
+    std::vector<int> readable;
+    std::vector<int> writable;
+    std::vector<Reset> resets;
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (stopped_) {
+                break;
+            }
+            resets.swap(reset_done_);
+        }
+
+        for (const auto& reset : resets) {
+            Reconnected(reset);
+        }
+        resets.clear();
+
+        Dispatch();
+
+        poller_.Wait(&readable, -1, &writable);
+
+        for (int s : writable) {
+            auto it = sockets_.find(s);
+            if (it != sockets_.end()) {
+                Send(it->second);
+            }
+        }
+
+        for (int s : readable) {
+            if (s == wakeup_[0]) {
+                char buf[64];
+                while (read(wakeup_[0], buf, sizeof(buf)) > 0) {
+                    ;
+                }
+                continue;
+            }
+
+            // The connection may have been marked broken while sending.
+            auto it = sockets_.find(s);
+            if (it != sockets_.end()) {
+                Receive(it->second);
+            }
+        }
+    }
+}
+
+void AsyncClient::Impl::Dispatch() {
+    for (auto& conn : connections_) {
+        if (conn.task || conn.resetting) {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (queue_.empty()) {
+                return;
+            }
+            conn.task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        if (conn.broken) {
+            Reconnect(&conn);
+        } else {
+            Start(&conn);
+        }
+    }
+}
+
+void AsyncClient::Impl::Start(Connection* conn) {
+    try {
+        if (conn->task->insert) {
+            conn->client->StartInsert(conn->task->table_name, conn->task->block);
+        } else {
+            conn->client->StartQuery(conn->task->query);
+        }
+
+        UpdateWrite(conn);
+    } catch (...) {
+        MarkBroken(conn);
+        Complete(conn, std::current_exception());
+    }
+}
+
+void AsyncClient::Impl::Receive(Connection* conn) {
+    try {
+        const bool finished = conn->client->ReceiveAvailable();
+
+        // Handling of a packet may have written data, e.g. the block
+        // of an insertion.
+        UpdateWrite(conn);
+
+        if (finished) {
+            Complete(conn, nullptr);
+        }
+    } catch (const ServerException&) {
+        Complete(conn, std::current_exception());
+    } catch (...) {
+        MarkBroken(conn);
+        Complete(conn, std::current_exception());
+    }
+}
+
+void AsyncClient::Impl::Send(Connection* conn) {
+    try {
+        UpdateWrite(conn);
+    } catch (...) {
+        MarkBroken(conn);
+        Complete(conn, std::current_exception());
+    }
+}
+
+void AsyncClient::Impl::UpdateWrite(Connection* conn) {
+    const bool writing = !conn->client->SendAvailable();
+
+    if (writing != conn->writing) {
+        poller_.WatchWrite(conn->client->GetSocket(), writing);
+        conn->writing = writing;
+    }
+}
+
+void AsyncClient::Impl::Complete(Connection* conn, std::exception_ptr error) {
+    if (!conn->task) {
+        return;
+    }
+
+    std::unique_ptr<Task> task = std::move(conn->task);
+
+    if (error) {
+        task->promise.set_exception(error);
+    } else {
+        task->promise.set_value();
+    }
+}
+
+void AsyncClient::Impl::Fail(std::exception_ptr error) noexcept {
+    std::deque<std::unique_ptr<Task>> queue;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        error_ = error;
+        queue.swap(queue_);
+    }
+
+    for (auto& conn : connections_) {
+        Complete(&conn, error);
+    }
+    for (auto& task : queue) {
+        task->promise.set_exception(error);
+    }
+}
+
+void AsyncClient::Impl::MarkBroken(Connection* conn) noexcept {
+    if (!conn->broken) {
+        poller_.Remove(conn->client->GetSocket());
+        sockets_.erase(conn->client->GetSocket());
+        conn->broken = true;
+        conn->writing = false;
+    }
+}
+
+void AsyncClient::Impl::Reconnect(Connection* conn) {
+    conn->resetting = true;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        resets_.push_back(conn);
+    }
+
+    reset_cond_.notify_one();
+}
+
+void AsyncClient::Impl::Reconnected(const Reset& reset) {
+    Connection* conn = reset.conn;
+
+    conn->resetting = false;
+
+    if (reset.error) {
+        Complete(conn, reset.error);
+        return;
+    }
+
+    try {
+        poller_.Add(conn->client->GetSocket());
+        sockets_[conn->client->GetSocket()] = conn;
+        conn->broken = false;
+    } catch (...) {
+        Complete(conn, std::current_exception());
+        return;
+    }
+
+    Start(conn);
+}
+
+void AsyncClient::Impl::Wakeup() noexcept {
+    const char c = 0;
+    // Fails only if the pipe is full, then the loop is woken up anyway.
+    (void)!write(wakeup_[1], &c, 1);
+}
+
+
+AsyncClient::AsyncClient(const ClientOptions& opts, size_t connections)
+    : impl_(new Impl(opts, connections))
+{
+}
+
+AsyncClient::~AsyncClient()
+{ }
+
+std::future<void> AsyncClient::Execute(const Query& query) {
+    return impl_->Execute(query);
+}
+
+std::future<void> AsyncClient::Select(const std::string& query, SelectCallback cb) {
+    return Execute(Query(query).OnData(cb));
+}
+
+std::future<void> AsyncClient::Insert(const std::string& table_name, const Block& block) {
+    return impl_->Insert(table_name, block);
+}
+
+}
+
+#endif
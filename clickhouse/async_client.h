@@ -0,0 +1,52 @@
+#pragma once
+
+#include "client.h"
+
+#if defined(_unix_)
+
+#include <future>
+#include <memory>
+#include <string>
+
+namespace clickhouse {
+
+/**
+ * Client which drives many connections to the same server from a single
+ * event loop thread.
+ *
+ * Requests are queued and started on the first idle connection, so up to
+ * \p connections queries are executed concurrently.  Result blocks and
+ * other events are delivered through the query's handlers, which are
+ * invoked on the event loop thread and should not block.  Completion or
+ * failure of a request is reported through the returned future.
+ *
+ * Available on Unix platforms only.
+ */
+class AsyncClient {
+public:
+     AsyncClient(const ClientOptions& opts, size_t connections = 1);
+    ~AsyncClient();
+
+    /// Intends for execute arbitrary queries.
+    std::future<void> Execute(const Query& query);
+
+    /// Intends for execute select queries.  Data will be returned with
+    /// one or more call of \p cb on the event loop thread.
+    std::future<void> Select(const std::string& query, SelectCallback cb);
+
+    /// Intends for insert block of data into a table \p table_name.
+    /// Columns of the block must not be modified until the insertion
+    /// has finished.
+    std::future<void> Insert(const std::string& table_name, const Block& block);
+
+private:
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator = (const AsyncClient&) = delete;
+
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
+
+#endif
@@ -4,8 +4,6 @@
 
 namespace clickhouse {
 
-static const int MAX_VARINT_BYTES = 10;
-
 CodedInputStream::CodedInputStream(ZeroCopyInput* input)
     : input_(input)
 {
@@ -18,6 +16,10 @@ bool CodedInputStream::ReadRaw(void* buffer, size_t size) {
         const void* ptr;
         size_t len = input_->Next(&ptr, size);
 
+        if (len == 0) {
+            return false;
+        }
+
         memcpy(p, ptr, len);
 
         p += len;
@@ -27,6 +29,10 @@ bool CodedInputStream::ReadRaw(void* buffer, size_t size) {
     return true;
 }
 
+size_t CodedInputStream::Peek(const void** ptr) {
+    return input_->Peek(ptr);
+}
+
 bool CodedInputStream::Skip(size_t count) {
     while (count > 0) {
         const void* ptr;
@@ -43,6 +49,20 @@ bool CodedInputStream::Skip(size_t count) {
 }
 
 bool CodedInputStream::ReadVarint64(uint64_t* value) {
+    const void* ptr;
+    const size_t len = input_->Peek(&ptr);
+
+    // Decode the value in place if it is entirely within the data at hand,
+    // otherwise fall back to reading byte by byte.
+    if (len) {
+        const size_t size = DecodeVarint(static_cast<const uint8_t*>(ptr), len, value);
+
+        if (size) {
+            input_->Next(&ptr, size);
+            return true;
+        }
+    }
+
     *value = 0;
 
     for (size_t i = 0; i < MAX_VARINT_BYTES; ++i) {
@@ -78,23 +98,9 @@ void CodedOutputStream::WriteRaw(const void* buffer, int size) {
 }
 
 void CodedOutputStream::WriteVarint64(uint64_t value) {
-    uint8_t bytes[MAX_VARINT_BYTES];
-    int size = 0;
-
-    for (size_t i = 0; i < MAX_VARINT_BYTES; ++i) {
-        uint8_t byte = value & 0x7F;
-        if (value > 0x7F)
-            byte |= 0x80;
-
-        bytes[size++] = byte;
-
-        value >>= 7;
-        if (!value) {
-            break;
-        }
-    }
+    uint8_t bytes[CodedInputStream::MAX_VARINT_BYTES];
 
-    WriteRaw(bytes, size);
+    WriteRaw(bytes, int(EncodeVarint(value, bytes)));
 }
 
 }
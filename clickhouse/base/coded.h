@@ -3,8 +3,14 @@
 #include "input.h"
 #include "output.h"
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 
+#if defined(__BMI2__)
+#   include <immintrin.h>
+#endif
+
 namespace clickhouse {
 
 /**
@@ -13,9 +19,15 @@ namespace clickhouse {
  */
 class CodedInputStream {
 public:
+    static constexpr size_t MAX_VARINT_BYTES = 10;
+
     /// Create a CodedInputStream that reads from the given ZeroCopyInput.
     explicit CodedInputStream(ZeroCopyInput* input);
 
+    /// Decodes a varint from a contiguous block of memory.  Returns count of
+    /// consumed bytes, or zero if the value does not end within the block.
+    static inline size_t DecodeVarint(const uint8_t* p, size_t len, uint64_t* value);
+
     // Read an unsigned integer with Varint encoding, truncating to 32 bits.
     // Reading a 32-bit value is equivalent to reading a 64-bit one and casting
     // it to uint32, but may be more efficient.
@@ -40,6 +52,10 @@ public:
     // occurs.
     bool Skip(size_t count);
 
+    // Obtains data which can be read without blocking, but does not consume
+    // it.  Data parsed in place should be consumed with Skip().
+    size_t Peek(const void** ptr);
+
 private:
     ZeroCopyInput* input_;
 };
@@ -55,6 +71,10 @@ public:
     // Write raw bytes, copying them from the given buffer.
     void WriteRaw(const void* buffer, int size);
 
+    /// Encodes a varint into \p p, which must have room for MAX_VARINT_BYTES.
+    /// Returns count of written bytes.
+    static inline size_t EncodeVarint(uint64_t value, uint8_t* p);
+
     /// Write an unsigned integer with Varint encoding.
     void WriteVarint64(const uint64_t value);
 
@@ -62,4 +82,64 @@ private:
     ZeroCopyOutput* output_;
 };
 
+
+inline size_t CodedInputStream::DecodeVarint(const uint8_t* p, size_t len, uint64_t* value) {
+#if defined(__BMI2__)
+    // Extract payload bits of up to eight bytes at once.
+    if (len >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+
+        const uint64_t stops = ~word & 0x8080808080808080ULL;
+
+        if (stops) {
+            const size_t size = (__builtin_ctzll(stops) >> 3) + 1;
+            const uint64_t mask = (size == 8) ? ~0ULL : (1ULL << (size * 8)) - 1;
+
+            *value = _pext_u64(word & mask, 0x7F7F7F7F7F7F7F7FULL);
+            return size;
+        }
+    }
+#endif
+
+    uint64_t result = 0;
+    const size_t limit = len < MAX_VARINT_BYTES ? len : MAX_VARINT_BYTES;
+
+    for (size_t i = 0; i < limit; ++i) {
+        result |= uint64_t(p[i] & 0x7F) << (7 * i);
+
+        if (!(p[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+inline size_t CodedOutputStream::EncodeVarint(uint64_t value, uint8_t* p) {
+#if defined(__BMI2__)
+    // Spread payload bits of values shorter than nine bytes at once.
+    if (value < (1ULL << 56)) {
+        const size_t bits = 64 - __builtin_clzll(value | 1);
+        const size_t size = (bits + 6) / 7;
+        const uint64_t more = 0x8080808080808080ULL & ((1ULL << ((size - 1) * 8)) - 1);
+        const uint64_t word = _pdep_u64(value, 0x7F7F7F7F7F7F7F7FULL) | more;
+
+        memcpy(p, &word, sizeof(word));
+        return size;
+    }
+#endif
+
+    size_t size = 0;
+
+    while (value > 0x7F) {
+        p[size++] = uint8_t(value) | 0x80;
+        value >>= 7;
+    }
+    p[size++] = uint8_t(value);
+
+    return size;
+}
+
 }
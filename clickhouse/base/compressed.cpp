@@ -1,9 +1,10 @@
 #include "compressed.h"
 #include "wire_format.h"
 
-#include <cityhash/city.h>
 #include <lz4/lz4.h>
+#include <zstd/zstd.h>
 
+#include <memory.h>
 #include <system_error>
 
 #define DBMS_MAX_COMPRESSED_SIZE    0x40000000ULL   // 1GB
@@ -25,6 +26,48 @@ size_t CompressedInput::DoNext(const void** ptr, size_t len) {
     return mem_.Next(ptr, len);
 }
 
+size_t CompressedInput::DoPeek(const void** ptr) {
+    return mem_.Peek(ptr);
+}
+
+size_t CompressedInput::FrameSize(const uint8_t* header) {
+    const uint8_t method = header[sizeof(uint128)];
+    uint32_t compressed;
+    memcpy(&compressed, header + sizeof(uint128) + 1, sizeof(compressed));
+
+    if (method != CompressionMethodByte::LZ4 && method != CompressionMethodByte::ZSTD) {
+        throw std::runtime_error("unsupported compression method " +
+                                 std::to_string(int(method)));
+    }
+    if (compressed > DBMS_MAX_COMPRESSED_SIZE) {
+        throw std::runtime_error("compressed data too big");
+    }
+    if (compressed < 9) {
+        throw std::runtime_error("data was corrupted");
+    }
+
+    return sizeof(uint128) + compressed;
+}
+
+/// Decompresses body of a frame.  Returns false if the data is malformed.
+static bool DecompressFrame(uint8_t method, const char* source, size_t compressed,
+                            char* dest, size_t original)
+{
+    switch (method) {
+        case CompressionMethodByte::LZ4: {
+            const int size = LZ4_decompress_safe(source, dest, compressed, original);
+            return size >= 0 && size_t(size) == original;
+        }
+
+        case CompressionMethodByte::ZSTD: {
+            const size_t size = ZSTD_decompress(dest, original, source, compressed);
+            return !ZSTD_isError(size) && size == original;
+        }
+    }
+
+    return false;
+}
+
 bool CompressedInput::Decompress() {
     uint128 hash;
     uint32_t compressed = 0;
@@ -38,7 +81,7 @@ bool CompressedInput::Decompress() {
         return false;
     }
 
-    if (method != 0x82) {
+    if (method != CompressionMethodByte::LZ4 && method != CompressionMethodByte::ZSTD) {
         throw std::runtime_error("unsupported compression method " +
                                  std::to_string(int(method)));
     } else {
@@ -52,35 +95,146 @@ bool CompressedInput::Decompress() {
         if (compressed > DBMS_MAX_COMPRESSED_SIZE) {
             throw std::runtime_error("compressed data too big");
         }
+        if (compressed < 9) {
+            throw std::runtime_error("data was corrupted");
+        }
 
-        Buffer tmp(compressed);
+        // Buffers are reused by consecutive frames of the same block.
+        compressed_.resize(compressed);
 
         // Заполнить заголовок сжатых данных.
         {
-            BufferOutput out(&tmp);
-            out.Write(&method,     sizeof(method));
-            out.Write(&compressed, sizeof(compressed));
-            out.Write(&original,   sizeof(original));
+            uint8_t* p = compressed_.data();
+            WriteUnaligned(p, method);     p += sizeof(method);
+            WriteUnaligned(p, compressed); p += sizeof(compressed);
+            WriteUnaligned(p, original);
         }
 
-        if (!WireFormat::ReadBytes(input_, tmp.data() + 9, compressed - 9)) {
+        if (!WireFormat::ReadBytes(input_, compressed_.data() + 9, compressed - 9)) {
             return false;
-        } else {
-            if (hash != CityHash128((const char*)tmp.data(), compressed)) {
-                throw std::runtime_error("data was corrupted");
-            }
         }
 
-        data_ = Buffer(original);
+        data_.resize(original);
+
+        const char* source = (const char*)compressed_.data();
+        const auto start = std::chrono::steady_clock::now();
+
+        if (hash != CityHash128(source, compressed)) {
+            throw std::runtime_error("data was corrupted");
+        }
+
+        const bool decompressed = DecompressFrame(method, source + 9, compressed - 9,
+                                                  (char*)data_.data(), original);
 
-        if (LZ4_decompress_fast((const char*)tmp.data() + 9, (char*)data_.data(), original) < 0) {
+        if (!decompressed) {
             throw std::runtime_error("can't decompress data");
-        } else {
-            mem_.Reset(data_.data(), original);
         }
+
+        decompress_time_ += std::chrono::steady_clock::now() - start;
+        compressed_bytes_ += compressed + sizeof(hash);
+        decompressed_bytes_ += original;
+
+        mem_.Reset(data_.data(), original);
     }
 
     return true;
 }
 
+
+
+CompressedOutput::CompressedOutput(OutputStream* destination, int method, int level,
+                                   size_t frame_size)
+    : destination_(destination)
+    , method_(method)
+    , level_(level)
+    , data_(frame_size)
+    , array_output_(data_.data(), data_.size())
+{
+    if (method_ == CompressionMethodByte::LZ4) {
+        compressed_.resize(9 + LZ4_compressBound(frame_size));
+    } else if (method_ == CompressionMethodByte::ZSTD) {
+        compressed_.resize(9 + ZSTD_compressBound(frame_size));
+    } else {
+        throw std::runtime_error("unsupported compression method " +
+                                 std::to_string(method));
+    }
+}
+
+CompressedOutput::~CompressedOutput() = default;
+
+void CompressedOutput::DoFlush() {
+    Compress();
+    destination_->Flush();
+}
+
+size_t CompressedOutput::DoNext(void** data, size_t len) {
+    if (array_output_.Exhausted()) {
+        Compress();
+    }
+
+    return array_output_.Next(data, len);
+}
+
+void CompressedOutput::DoWrite(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    while (len > 0) {
+        // Compress whole frames directly from the caller's memory.
+        if (array_output_.Data() == data_.data() && len >= data_.size()) {
+            WriteFrame(p, data_.size());
+            p += data_.size();
+            len -= data_.size();
+        } else {
+            void* ptr;
+            const size_t result = DoNext(&ptr, len);
+
+            memcpy(ptr, p, result);
+            p += result;
+            len -= result;
+        }
+    }
+}
+
+void CompressedOutput::Compress() {
+    const size_t len = array_output_.Data() - data_.data();
+
+    if (len) {
+        WriteFrame(data_.data(), len);
+        array_output_.Reset(data_.data(), data_.size());
+    }
+}
+
+void CompressedOutput::WriteFrame(const void* data, size_t len) {
+    size_t size;
+
+    if (method_ == CompressionMethodByte::LZ4) {
+        size = LZ4_compress((const char*)data, (char*)compressed_.data() + 9, len);
+    } else {
+        size = ZSTD_compress(compressed_.data() + 9, compressed_.size() - 9,
+                             data, len, level_);
+        if (ZSTD_isError(size)) {
+            throw std::runtime_error(std::string("can't compress data: ") +
+                                     ZSTD_getErrorName(size));
+        }
+    }
+
+    const uint32_t compressed = uint32_t(9 + size);
+    const uint32_t original = uint32_t(len);
+
+    // Fill header
+    uint8_t* p = compressed_.data();
+    WriteUnaligned(p, uint8_t(method_)); p += 1;
+    WriteUnaligned(p, compressed);       p += 4;
+    WriteUnaligned(p, original);
+
+    const uint128 hash = CityHash128((const char*)compressed_.data(), compressed);
+
+    const OutputSlice slices[] = {
+        { &hash, sizeof(hash) },
+        { compressed_.data(), compressed },
+    };
+
+    destination_->WriteV(slices, 2);
+}
+
 }
@@ -2,22 +2,97 @@
 
 #include "coded.h"
 
+#include <cityhash/city.h>
+
+#include <chrono>
+
 namespace clickhouse {
 
+/// Methods of compression of a frame, as stored in its header.
+namespace CompressionMethodByte {
+    enum {
+        LZ4     = 0x82,
+        ZSTD    = 0x90,
+    };
+}
+
+
 class CompressedInput : public ZeroCopyInput {
 public:
-     CompressedInput(CodedInputStream* input);
+     explicit CompressedInput(CodedInputStream* input);
+
+    /// Size of the header of a frame, including its checksum.
+    static constexpr size_t HEADER_SIZE = 25;
+
+    /// Returns the full size of a frame by its header of HEADER_SIZE bytes.
+    static size_t FrameSize(const uint8_t* header);
+
+    /// Total size of frames read so far.
+    inline uint64_t CompressedBytes() const noexcept {
+        return compressed_bytes_;
+    }
+
+    /// Total size of data decompressed so far.
+    inline uint64_t DecompressedBytes() const noexcept {
+        return decompressed_bytes_;
+    }
+
+    /// Time spent in checksum verification and decompression of frames.
+    inline std::chrono::nanoseconds DecompressTime() const noexcept {
+        return decompress_time_;
+    }
 
 protected:
     size_t DoNext(const void** ptr, size_t len) override;
+    size_t DoPeek(const void** ptr) override;
 
     bool Decompress();
 
 private:
     CodedInputStream* const input_;
 
+    Buffer compressed_;
     Buffer data_;
     ArrayInput mem_;
+
+    uint64_t compressed_bytes_ = 0;
+    uint64_t decompressed_bytes_ = 0;
+    std::chrono::nanoseconds decompress_time_{0};
+};
+
+
+/**
+ * Splits written data into compressed frames of a fixed size, so
+ * a frame is sent as soon as it has been filled and memory usage does
+ * not depend on the amount of written data.
+ *
+ * Flush() must be called to emit the last, incomplete frame.
+ */
+class CompressedOutput : public ZeroCopyOutput {
+public:
+     CompressedOutput(OutputStream* destination, int method, int level = 1,
+                      size_t frame_size = 1 << 20);
+    ~CompressedOutput() override;
+
+protected:
+    void DoFlush() override;
+    size_t DoNext(void** data, size_t len) override;
+    void DoWrite(const void* data, size_t len) override;
+
+    /// Compresses the data collected in the frame buffer.
+    void Compress();
+
+    /// Compresses \p len bytes into a frame and writes it to the destination.
+    void WriteFrame(const void* data, size_t len);
+
+private:
+    OutputStream* const destination_;
+    const int method_;
+    const int level_;
+
+    Buffer data_;
+    Buffer compressed_;
+    ArrayOutput array_output_;
 };
 
 }
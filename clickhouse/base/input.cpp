@@ -40,11 +40,17 @@ size_t ArrayInput::DoNext(const void** ptr, size_t len) {
     return len;
 }
 
+size_t ArrayInput::DoPeek(const void** ptr) {
+    *ptr = data_;
+    return len_;
+}
+
 
-BufferedInput::BufferedInput(InputStream* slave, size_t buflen)
+BufferedInput::BufferedInput(InputStream* slave, size_t buflen, size_t max_buflen)
     : slave_(slave)
     , array_input_(nullptr, 0)
     , buffer_(buflen)
+    , max_buflen_(max_buflen)
 {
 }
 
@@ -56,26 +62,45 @@ void BufferedInput::Reset() {
 
 size_t BufferedInput::DoNext(const void** ptr, size_t len)  {
     if (array_input_.Exhausted()) {
-        array_input_.Reset(
-            buffer_.data(), slave_->Read(buffer_.data(), buffer_.size())
-        );
+        Refill();
     }
 
     return array_input_.Next(ptr, len);
 }
 
+size_t BufferedInput::DoPeek(const void** ptr) {
+    return array_input_.Peek(ptr);
+}
+
 size_t BufferedInput::DoRead(void* buf, size_t len) {
     if (array_input_.Exhausted()) {
         if (len > buffer_.size() / 2) {
             return slave_->Read(buf, len);
         }
 
-        array_input_.Reset(
-            buffer_.data(), slave_->Read(buffer_.data(), buffer_.size())
-        );
+        Refill();
     }
 
     return array_input_.Read(buf, len);
 }
 
+void BufferedInput::Refill() {
+    // Two reads in a row which filled the whole buffer mean the slave has
+    // more data than fits into it, so read bigger chunks from now on.
+    if (full_reads_ >= 2 && buffer_.size() < max_buflen_) {
+        buffer_.resize(std::min(buffer_.size() * 2, max_buflen_));
+        full_reads_ = 0;
+    }
+
+    const size_t len = slave_->Read(buffer_.data(), buffer_.size());
+
+    if (len == buffer_.size()) {
+        ++full_reads_;
+    } else {
+        full_reads_ = 0;
+    }
+
+    array_input_.Reset(buffer_.data(), len);
+}
+
 }
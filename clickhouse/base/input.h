@@ -32,9 +32,19 @@ public:
         return DoNext(buf, len);
     }
 
+    /// Obtains data which is available without blocking, but does not
+    /// consume it.  Returns zero if no such data is at hand.
+    inline size_t Peek(const void** buf) {
+        return DoPeek(buf);
+    }
+
 protected:
     virtual size_t DoNext(const void** ptr, size_t len) = 0;
 
+    virtual size_t DoPeek(const void** /*ptr*/) {
+        return 0;
+    }
+
     size_t DoRead(void* buf, size_t len) override;
 };
 
@@ -70,6 +80,7 @@ public:
 
 private:
     size_t DoNext(const void** ptr, size_t len) override;
+    size_t DoPeek(const void** ptr) override;
 
 private:
     const uint8_t* data_;
@@ -77,9 +88,14 @@ private:
 };
 
 
+/**
+ * Reads the slave stream by large chunks.  If \p max_buflen is greater
+ * than \p buflen, the buffer grows while the slave keeps filling it
+ * completely, so bulk transfers take fewer reads.
+ */
 class BufferedInput : public ZeroCopyInput {
 public:
-     BufferedInput(InputStream* slave, size_t buflen = 8192);
+     BufferedInput(InputStream* slave, size_t buflen = 8192, size_t max_buflen = 0);
     ~BufferedInput() override;
 
     void Reset();
@@ -87,11 +103,18 @@ public:
 protected:
     size_t DoRead(void* buf, size_t len) override;
     size_t DoNext(const void** ptr, size_t len) override;
+    size_t DoPeek(const void** ptr) override;
+
+    /// Fills the buffer with the next chunk of data from the slave.
+    void Refill();
 
 private:
     InputStream* const slave_;
     ArrayInput array_input_;
     std::vector<uint8_t> buffer_;
+    const size_t max_buflen_;
+    /// Count of consecutive reads which filled the buffer completely.
+    size_t full_reads_ = 0;
 };
 
 }
@@ -6,6 +6,13 @@
 
 namespace clickhouse {
 
+void OutputStream::DoWriteV(const OutputSlice* slices, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        DoWrite(slices[i].data, slices[i].len);
+    }
+}
+
+
 void ZeroCopyOutput::DoWrite(const void* data, size_t len) {
     while (len > 0) {
         void* ptr;
@@ -79,10 +86,13 @@ void BufferedOutput::Reset() {
 
 void BufferedOutput::DoFlush() {
     if (array_output_.Data() != buffer_.data()) {
-        slave_->Write(buffer_.data(), array_output_.Data() - buffer_.data());
-        slave_->Flush();
-
+        const size_t len = array_output_.Data() - buffer_.data();
+        // Data is dropped even if the write fails, so the destructor
+        // doesn't throw trying to flush it again.
         array_output_.Reset(buffer_.data(), buffer_.size());
+
+        slave_->Write(buffer_.data(), len);
+        slave_->Flush();
     }
 }
 
@@ -96,16 +106,47 @@ size_t BufferedOutput::DoNext(void** data, size_t len) {
 }
 
 void BufferedOutput::DoWrite(const void* data, size_t len) {
-    if (array_output_.Avail() < len) {
+    const OutputSlice slice = { data, len };
+
+    DoWriteV(&slice, 1);
+}
+
+void BufferedOutput::DoWriteV(const OutputSlice* slices, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += slices[i].len;
+    }
+
+    if (array_output_.Avail() >= total) {
+        for (size_t i = 0; i < count; ++i) {
+            array_output_.Write(slices[i].data, slices[i].len);
+        }
+        return;
+    }
+
+    if (total <= buffer_.size() / 2) {
         Flush();
 
-        if (len > buffer_.size() / 2) {
-            slave_->Write(data, len);
-            return;
+        for (size_t i = 0; i < count; ++i) {
+            array_output_.Write(slices[i].data, slices[i].len);
         }
+        return;
     }
 
-    array_output_.Write(data, len);
+    // Send buffered data together with the slices in one call,
+    // without copying the slices into the buffer.
+    std::vector<OutputSlice> parts;
+    parts.reserve(count + 1);
+
+    if (array_output_.Data() != buffer_.data()) {
+        parts.push_back({ buffer_.data(), size_t(array_output_.Data() - buffer_.data()) });
+    }
+    parts.insert(parts.end(), slices, slices + count);
+
+    slave_->WriteV(parts.data(), parts.size());
+    slave_->Flush();
+
+    array_output_.Reset(buffer_.data(), buffer_.size());
 }
 
 }
@@ -9,6 +9,13 @@
 
 namespace clickhouse {
 
+/// A piece of data in memory for gathering writes.
+struct OutputSlice {
+    const void* data;
+    size_t len;
+};
+
+
 class OutputStream {
 public:
     virtual ~OutputStream()
@@ -22,10 +29,19 @@ public:
         DoWrite(data, len);
     }
 
+    /// Writes \p count slices of data one after another.
+    inline void WriteV(const OutputSlice* slices, size_t count) {
+        DoWriteV(slices, count);
+    }
+
 protected:
     virtual void DoFlush() { }
 
     virtual void DoWrite(const void* data, size_t len) = 0;
+
+    /// Writes slices one by one.  Streams which can send several slices
+    /// at once override this method.
+    virtual void DoWriteV(const OutputSlice* slices, size_t count);
 };
 
 
@@ -111,6 +127,7 @@ protected:
     void DoFlush() override;
     size_t DoNext(void** data, size_t len) override;
     void DoWrite(const void* data, size_t len) override;
+    void DoWriteV(const OutputSlice* slices, size_t count) override;
 
 private:
     OutputStream* const slave_;
@@ -1,6 +1,7 @@
 #include "socket.h"
 #include "singleton.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <stdexcept>
 #include <system_error>
@@ -13,9 +14,14 @@
 #   include <netdb.h>
 #   include <netinet/tcp.h>
 #   include <signal.h>
+#   include <sys/uio.h>
 #   include <unistd.h>
 #endif
 
+#if defined(_linux_)
+#   include <sys/epoll.h>
+#endif
+
 namespace clickhouse {
 namespace {
 
@@ -168,6 +174,11 @@ void SocketHolder::SetTcpKeepAlive(int idle, int intvl, int cnt) noexcept {
 #endif
 }
 
+void SocketHolder::SetTcpNoDelay(bool nodelay) noexcept {
+    int val = nodelay;
+    setsockopt(handle_, IPPROTO_TCP, TCP_NODELAY, (const char*)&val, sizeof(val));
+}
+
 SocketHolder& SocketHolder::operator = (SocketHolder&& other) noexcept {
     if (this != &other) {
         Close();
@@ -209,6 +220,33 @@ size_t SocketInput::DoRead(void* buf, size_t len) {
     );
 }
 
+size_t SocketInput::ReadAvailable(void* buf, size_t len) {
+#if defined(_unix_)
+    while (true) {
+        const ssize_t ret = ::recv(s_, (char*)buf, len, MSG_DONTWAIT);
+
+        if (ret > 0) {
+            return (size_t)ret;
+        }
+        if (ret == 0) {
+            throw std::system_error(
+                errno, std::system_category(), "closed"
+            );
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            throw std::system_error(
+                errno, std::system_category(), "can't receive string data"
+            );
+        }
+    }
+#else
+    return DoRead(buf, len);
+#endif
+}
+
 
 SocketOutput::SocketOutput(SOCKET s)
     : s_(s)
@@ -231,6 +269,252 @@ void SocketOutput::DoWrite(const void* data, size_t len) {
     }
 }
 
+size_t SocketOutput::WriteAvailable(const void* data, size_t len) {
+#if defined(_unix_)
+#   if defined (_linux_)
+    static const int flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#   else
+    static const int flags = MSG_DONTWAIT;
+#   endif
+
+    while (true) {
+        const ssize_t ret = ::send(s_, (const char*)data, len, flags);
+
+        if (ret >= 0) {
+            return (size_t)ret;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            throw std::system_error(
+                errno, std::system_category(), "fail to send data"
+            );
+        }
+    }
+#else
+    DoWrite(data, len);
+    return len;
+#endif
+}
+
+void SocketOutput::DoWriteV(const OutputSlice* slices, size_t count) {
+#if defined(_unix_)
+#   if defined (_linux_)
+    static const int flags = MSG_NOSIGNAL;
+#   else
+    static const int flags = 0;
+#   endif
+    // Keep well below IOV_MAX, which is at least 16 by POSIX.
+    static const size_t MAX_IOV = 16;
+
+    struct iovec iov[MAX_IOV];
+
+    while (count > 0) {
+        const size_t n = std::min(count, MAX_IOV);
+
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = const_cast<void*>(slices[i].data);
+            iov[i].iov_len = slices[i].len;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+
+        size_t done = 0;
+        while (done < n) {
+            const ssize_t ret = ::sendmsg(s_, &msg, flags);
+
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(
+                    errno, std::system_category(), "fail to send data"
+                );
+            }
+
+            // Skip data which has been sent.
+            size_t sent = (size_t)ret;
+            while (done < n && sent >= iov[done].iov_len) {
+                sent -= iov[done].iov_len;
+                ++done;
+            }
+            if (done < n) {
+                iov[done].iov_base = static_cast<char*>(iov[done].iov_base) + sent;
+                iov[done].iov_len -= sent;
+            }
+
+            msg.msg_iov = iov + done;
+            msg.msg_iovlen = n - done;
+        }
+
+        slices += n;
+        count -= n;
+    }
+#else
+    OutputStream::DoWriteV(slices, count);
+#endif
+}
+
+
+#if defined(_linux_)
+
+SocketPoller::SocketPoller()
+    : epoll_(epoll_create1(EPOLL_CLOEXEC))
+    , count_(0)
+{
+    if (epoll_ == -1) {
+        throw std::system_error(
+            errno, std::system_category(), "fail to create epoll instance"
+        );
+    }
+}
+
+SocketPoller::~SocketPoller() {
+    close(epoll_);
+}
+
+void SocketPoller::Add(SOCKET s) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = s;
+
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, s, &ev) == -1) {
+        throw std::system_error(
+            errno, std::system_category(), "fail to watch socket"
+        );
+    }
+    ++count_;
+}
+
+void SocketPoller::Remove(SOCKET s) noexcept {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+
+    if (epoll_ctl(epoll_, EPOLL_CTL_DEL, s, &ev) == 0) {
+        --count_;
+    }
+}
+
+void SocketPoller::WatchWrite(SOCKET s, bool value) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = value ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.fd = s;
+
+    if (epoll_ctl(epoll_, EPOLL_CTL_MOD, s, &ev) == -1) {
+        throw std::system_error(
+            errno, std::system_category(), "fail to watch socket"
+        );
+    }
+}
+
+void SocketPoller::Wait(std::vector<SOCKET>* ready, int timeout,
+                        std::vector<SOCKET>* writable)
+{
+    std::vector<struct epoll_event> events(std::max<size_t>(count_, 1));
+
+    ready->clear();
+    if (writable) {
+        writable->clear();
+    }
+
+    const int ret = epoll_wait(epoll_, events.data(), (int)events.size(), timeout);
+
+    if (ret == -1) {
+        if (errno == EINTR) {
+            return;
+        }
+        throw std::system_error(
+            errno, std::system_category(), "fail to wait for events"
+        );
+    }
+
+    for (int i = 0; i < ret; ++i) {
+        // Errors are reported as incoming data, so they are noticed
+        // by the reader.
+        if (events[i].events & ~EPOLLOUT) {
+            ready->push_back(events[i].data.fd);
+        }
+        if ((events[i].events & EPOLLOUT) && writable) {
+            writable->push_back(events[i].data.fd);
+        }
+    }
+}
+
+#else
+
+SocketPoller::SocketPoller() = default;
+
+SocketPoller::~SocketPoller() = default;
+
+void SocketPoller::Add(SOCKET s) {
+    pollfd fd;
+    fd.fd = s;
+    fd.events = POLLIN;
+    fd.revents = 0;
+
+    fds_.push_back(fd);
+}
+
+void SocketPoller::Remove(SOCKET s) noexcept {
+    for (auto it = fds_.begin(); it != fds_.end(); ++it) {
+        if (it->fd == s) {
+            fds_.erase(it);
+            break;
+        }
+    }
+}
+
+void SocketPoller::WatchWrite(SOCKET s, bool value) {
+    for (auto& fd : fds_) {
+        if (fd.fd == s) {
+            fd.events = value ? (POLLIN | POLLOUT) : POLLIN;
+            return;
+        }
+    }
+
+    throw std::runtime_error("socket is not watched");
+}
+
+void SocketPoller::Wait(std::vector<SOCKET>* ready, int timeout,
+                        std::vector<SOCKET>* writable)
+{
+    ready->clear();
+    if (writable) {
+        writable->clear();
+    }
+
+    const ssize_t ret = Poll(fds_.data(), (int)fds_.size(), timeout);
+
+    if (ret == -1) {
+        if (errno == EINTR) {
+            return;
+        }
+        throw std::system_error(
+            errno, std::system_category(), "fail to wait for events"
+        );
+    }
+
+    for (auto& fd : fds_) {
+        // Errors are reported as incoming data, so they are noticed
+        // by the reader.
+        if (fd.revents & ~POLLOUT) {
+            ready->push_back(fd.fd);
+        }
+        if ((fd.revents & POLLOUT) && writable) {
+            writable->push_back(fd.fd);
+        }
+        fd.revents = 0;
+    }
+}
+
+#endif
+
 
 NetworkInitializer::NetworkInitializer() {
     struct NetworkInitializerImpl {
@@ -253,7 +537,7 @@ NetworkInitializer::NetworkInitializer() {
 }
 
 
-SOCKET SocketConnect(const NetworkAddress& addr) {
+SOCKET SocketConnect(const NetworkAddress& addr, int receive_buffer, int send_buffer) {
     int last_err = 0;
     for (auto res = addr.Info(); res != nullptr; res = res->ai_next) {
         SOCKET s(socket(res->ai_family, res->ai_socktype, res->ai_protocol));
@@ -262,6 +546,13 @@ SOCKET SocketConnect(const NetworkAddress& addr) {
             continue;
         }
 
+        if (receive_buffer > 0) {
+            setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char*)&receive_buffer, sizeof(receive_buffer));
+        }
+        if (send_buffer > 0) {
+            setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char*)&send_buffer, sizeof(send_buffer));
+        }
+
         SetNonBlock(s, true);
 
         if (connect(s, res->ai_addr, (int)res->ai_addrlen) != 0) {
@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 #if defined(_win_)
 #   pragma comment(lib, "Ws2_32.lib")
@@ -62,6 +63,10 @@ public:
     ///         before dropping the connection.
     void SetTcpKeepAlive(int idle, int intvl, int cnt) noexcept;
 
+    /// Sends small writes immediately instead of coalescing them
+    /// (Nagle's algorithm).
+    void SetTcpNoDelay(bool nodelay) noexcept;
+
     SocketHolder& operator = (SocketHolder&& other) noexcept;
 
     operator SOCKET () const noexcept;
@@ -82,6 +87,10 @@ public:
     explicit SocketInput(SOCKET s);
     ~SocketInput();
 
+    /// Receives data which has arrived to the socket without blocking.
+    /// Returns count of received bytes, or zero if there is no data.
+    size_t ReadAvailable(void* buf, size_t len);
+
 protected:
     size_t DoRead(void* buf, size_t len) override;
 
@@ -94,19 +103,66 @@ public:
     explicit SocketOutput(SOCKET s);
     ~SocketOutput();
 
+    /// Sends as much of the data as the socket accepts without blocking.
+    /// Returns count of sent bytes.
+    size_t WriteAvailable(const void* data, size_t len);
+
 protected:
     void DoWrite(const void* data, size_t len) override;
 
+    /// Sends all slices with a single sendmsg() call where possible.
+    void DoWriteV(const OutputSlice* slices, size_t count) override;
+
 private:
     SOCKET s_;
 };
 
+/**
+ * Waits for incoming data on many sockets at once, and optionally for
+ * the ability to send data.  Uses epoll on Linux and falls back to poll()
+ * on other platforms.
+ */
+class SocketPoller {
+public:
+     SocketPoller();
+    ~SocketPoller();
+
+    /// Starts watching the socket for incoming data.
+    void Add(SOCKET s);
+
+    /// Stops watching the socket.
+    void Remove(SOCKET s) noexcept;
+
+    /// Starts or stops watching the socket for the ability to send data.
+    void WatchWrite(SOCKET s, bool value);
+
+    /// Waits up to \p timeout milliseconds (infinitely if negative) and
+    /// stores sockets which have data to read into \p ready.  Sockets
+    /// watched for writing which can send data are stored into \p writable.
+    void Wait(std::vector<SOCKET>* ready, int timeout,
+              std::vector<SOCKET>* writable = nullptr);
+
+private:
+    SocketPoller(const SocketPoller&) = delete;
+    SocketPoller& operator = (const SocketPoller&) = delete;
+
+#if defined(_linux_)
+    int epoll_;
+    size_t count_;
+#else
+    std::vector<struct pollfd> fds_;
+#endif
+};
+
 static struct NetworkInitializer {
     NetworkInitializer();
 } gNetworkInitializer;
 
-///
-SOCKET SocketConnect(const NetworkAddress& addr);
+/// Connects to the given address.  Non-zero \p receive_buffer and
+/// \p send_buffer set sizes of kernel buffers of the socket; they are
+/// applied before connecting, so the TCP window scale can match them.
+SOCKET SocketConnect(const NetworkAddress& addr,
+                     int receive_buffer = 0, int send_buffer = 0);
 
 ssize_t Poll(struct pollfd* fds, int nfds, int timeout) noexcept;
 
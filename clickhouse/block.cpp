@@ -63,6 +63,10 @@ const BlockInfo& Block::Info() const {
     return info_;
 }
 
+void Block::SetInfo(BlockInfo info) {
+    info_ = info;
+}
+
 /// Count of rows in the block.
 size_t Block::GetRowCount() const {
     return rows_;
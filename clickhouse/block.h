@@ -4,8 +4,14 @@
 
 namespace clickhouse {
 
+/// Additional information which the server sends with every block.
 struct BlockInfo {
+    /// The block holds rows of keys which exceeded max_rows_to_group_by
+    /// with group_by_overflow_mode = 'any'.
     uint8_t is_overflows = 0;
+    /// Number of the bucket of two-level aggregation the block belongs to,
+    /// or -1.  Blocks of different buckets have no keys in common, so they
+    /// can be merged independently and in parallel.
     int32_t bucket_num = -1;
 };
 
@@ -51,6 +57,9 @@ public:
 
     const BlockInfo& Info() const;
 
+    /// Set additional information about the block.
+    void SetInfo(BlockInfo info);
+
     /// Count of rows in the block.
     size_t GetRowCount() const;
 
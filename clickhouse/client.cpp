@@ -8,11 +8,14 @@
 
 #include "columns/factory.h"
 
-#include <cityhash/city.h>
-#include <lz4/lz4.h>
+#include "types/type_parser.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <atomic>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 #include <system_error>
 #include <thread>
 #include <vector>
@@ -66,11 +69,280 @@ std::ostream& operator<<(std::ostream& os, const ClientOptions& opt) {
        << " send_retries:" << opt.send_retries
        << " retry_timeout:" << opt.retry_timeout.count()
        << " compression_method:"
-       << (opt.compression_method == CompressionMethod::LZ4 ? "LZ4" : "None")
+       << (opt.compression_method == CompressionMethod::LZ4 ? "LZ4" :
+           opt.compression_method == CompressionMethod::ZSTD ? "ZSTD" : "None")
        << ")";
     return os;
 }
 
+namespace {
+
+/// Serves data received so far by an asynchronous connection.  Reading
+/// past the end fails like reading of a closed stream, and the fact is
+/// recorded, so the caller waits for more data and resumes reading.
+class ReceivedInput : public ZeroCopyInput {
+public:
+    ReceivedInput(const uint8_t* data, size_t len, bool* exhausted) noexcept
+        : data_(data)
+        , len_(len)
+        , pos_(0)
+        , exhausted_(exhausted)
+    {
+    }
+
+    /// Count of bytes consumed from the input.
+    inline size_t Position() const noexcept {
+        return pos_;
+    }
+
+    /// Count of bytes which have not been consumed yet.
+    inline size_t Avail() const noexcept {
+        return len_ - pos_;
+    }
+
+protected:
+    size_t DoNext(const void** ptr, size_t len) override {
+        if (pos_ == len_) {
+            *exhausted_ = true;
+            return 0;
+        }
+
+        len = std::min(len, len_ - pos_);
+
+        *ptr  = data_ + pos_;
+        pos_ += len;
+
+        return len;
+    }
+
+    size_t DoPeek(const void** ptr) override {
+        *ptr = data_ + pos_;
+        return len_ - pos_;
+    }
+
+private:
+    const uint8_t* const data_;
+    const size_t len_;
+    size_t pos_;
+    bool* const exhausted_;
+};
+
+/// Counts reads of the slave stream and time spent in them, while
+/// statistics are collected.
+class MeasuredInput : public InputStream {
+public:
+    explicit MeasuredInput(InputStream* slave) noexcept
+        : slave_(slave)
+    {
+    }
+
+    /// Starts counting in \p stats, or stops counting if it is nullptr.
+    inline void Measure(QueryStats* stats) noexcept {
+        stats_ = stats;
+    }
+
+    /// Counts a read done by \p read, which returns count of read bytes.
+    template <typename Read>
+    size_t Count(Read read) {
+        if (!stats_) {
+            return read();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t ret = read();
+
+        stats_->read_time += std::chrono::steady_clock::now() - start;
+        stats_->socket_reads += 1;
+        stats_->bytes_received += ret;
+
+        return ret;
+    }
+
+protected:
+    size_t DoRead(void* buf, size_t len) override {
+        return Count([this, buf, len] () { return slave_->Read(buf, len); });
+    }
+
+private:
+    InputStream* const slave_;
+    QueryStats* stats_ = nullptr;
+};
+
+/// Counts writes to the slave stream and time spent in them, while
+/// statistics are collected.
+class MeasuredOutput : public OutputStream {
+public:
+    explicit MeasuredOutput(OutputStream* slave) noexcept
+        : slave_(slave)
+    {
+    }
+
+    /// Starts counting in \p stats, or stops counting if it is nullptr.
+    inline void Measure(QueryStats* stats) noexcept {
+        stats_ = stats;
+    }
+
+protected:
+    void DoWrite(const void* data, size_t len) override {
+        const OutputSlice slice{data, len};
+        DoWriteV(&slice, 1);
+    }
+
+    void DoWriteV(const OutputSlice* slices, size_t count) override {
+        if (!stats_) {
+            slave_->WriteV(slices, count);
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        slave_->WriteV(slices, count);
+
+        stats_->write_time += std::chrono::steady_clock::now() - start;
+        stats_->socket_writes += 1;
+        for (size_t i = 0; i < count; ++i) {
+            stats_->bytes_sent += slices[i].len;
+        }
+    }
+
+private:
+    OutputStream* const slave_;
+    QueryStats* stats_ = nullptr;
+};
+
+/// Writes data to the socket or, while the connection is driven by an event
+/// loop, collects it to be sent without blocking when the socket becomes
+/// writable.
+class DeferredOutput : public OutputStream {
+public:
+    explicit DeferredOutput(SocketOutput* socket) noexcept
+        : socket_(socket)
+    {
+    }
+
+    /// Starts or stops collecting data instead of writing it to the socket.
+    inline void Defer(bool value) noexcept {
+        deferred_ = value;
+    }
+
+    /// Drops collected data.
+    inline void Clear() noexcept {
+        data_.clear();
+        sent_ = 0;
+    }
+
+    /// Sends as much of collected data as the socket accepts without
+    /// blocking.  Returns true if all data has been sent.
+    bool SendAvailable() {
+        while (sent_ < data_.size()) {
+            const size_t ret = socket_->WriteAvailable(data_.data() + sent_, data_.size() - sent_);
+            if (ret == 0) {
+                return false;
+            }
+            sent_ += ret;
+        }
+
+        Clear();
+        return true;
+    }
+
+protected:
+    void DoWrite(const void* data, size_t len) override {
+        if (deferred_) {
+            data_.insert(data_.end(),
+                static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + len);
+        } else {
+            socket_->Write(data, len);
+        }
+    }
+
+    void DoWriteV(const OutputSlice* slices, size_t count) override {
+        if (deferred_) {
+            OutputStream::DoWriteV(slices, count);
+        } else {
+            socket_->WriteV(slices, count);
+        }
+    }
+
+private:
+    SocketOutput* const socket_;
+    bool deferred_ = false;
+    Buffer data_;
+    /// Count of collected bytes which have been sent.
+    size_t sent_ = 0;
+};
+
+/// Forwards allocations to the upstream resource and counts them.
+/// Columns may outlive the client, so the client releases the resource
+/// and it is deleted once the last allocation has been freed.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) noexcept
+        : upstream_(upstream)
+    {
+    }
+
+    /// Drops the reference of the owner.
+    inline void Release() noexcept {
+        Unref();
+    }
+
+    inline std::pmr::memory_resource* Upstream() const noexcept {
+        return upstream_;
+    }
+
+    inline uint64_t Allocations() const noexcept {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t AllocatedBytes() const noexcept {
+        return allocated_bytes_.load(std::memory_order_relaxed);
+    }
+
+private:
+    ~CountingResource() override = default;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* p = upstream_->allocate(bytes, alignment);
+
+        refs_.fetch_add(1, std::memory_order_relaxed);
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+        Unref();
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void Unref() noexcept {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+private:
+    std::pmr::memory_resource* const upstream_;
+    /// The owner and every allocation not freed yet.
+    std::atomic<size_t> refs_{1};
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> allocated_bytes_{0};
+};
+
+struct ReleaseResource {
+    void operator () (CountingResource* resource) const noexcept {
+        resource->Release();
+    }
+};
+
+} // namespace
+
 class Client::Impl {
 public:
      Impl(const ClientOptions& opts);
@@ -82,33 +354,115 @@ public:
 
     void Insert(const std::string& table_name, const Block& block);
 
+    void BeginInsert(const std::string& table_name, const std::vector<std::string>& column_names);
+
+    void InsertData(const Block& block);
+
+    void EndInsert();
+
+    void BeginSelect(const Query& query);
+
+    bool ReceiveBlock(Block* block);
+
+    void EndSelect();
+
     void Ping();
 
     void ResetConnection();
 
+    bool IsIdle() const noexcept;
+
+public:
+    /// Asynchronous mode: the connection is driven by an event loop,
+    /// which calls ReceiveAvailable() whenever the socket has data to read
+    /// and SendAvailable() whenever written data remains to be sent.
+
+    /// Socket of the connection.
+    SOCKET GetSocket() const;
+
+    /// Sends a query without waiting for the response.
+    void StartQuery(Query query);
+
+    /// Sends an insert query.  The block will be sent as soon as
+    /// the server acknowledges the query.
+    void StartInsert(const std::string& table_name, const Block& block);
+
+    /// Reads data available in the socket without blocking and handles
+    /// all completely received packets.  Returns true when the current
+    /// query has finished.
+    bool ReceiveAvailable();
+
+    /// Sends data written by the asynchronous query as far as the socket
+    /// accepts it without blocking.  Returns true if all data has been sent.
+    bool SendAvailable();
+
 private:
+    /// Throws if a query started with BeginInsert or BeginSelect
+    /// has not been completed yet.
+    void EnsureIdle() const;
+
+    /// Leaves the state of a select started by BeginSelect.
+    void FinishSelect();
+
     bool Handshake();
 
     bool ReceivePacket(uint64_t* server_packet = nullptr);
 
-    void SendQuery(const std::string& query);
+    /// Reads one packet from the given input stream.
+    bool ReceivePacket(CodedInputStream* input, uint64_t* server_packet);
+
+    void SendQuery(const std::string& query, const QuerySettings& settings = QuerySettings());
 
     void SendData(const Block& block);
 
     bool SendHello();
 
-    bool ReadBlock(Block* block, CodedInputStream* input);
+    /// Progress of reading of a block.  In asynchronous mode reading
+    /// stops when received data runs out, and the next attempt resumes
+    /// with the first column which has not been read completely.
+    struct BlockState {
+        /// Received data the block is read from in asynchronous mode.
+        const ReceivedInput* source = nullptr;
+        /// Position in the source after the last completely read part.
+        size_t resume = 0;
+        /// Info and sizes of the block have been read.
+        bool started = false;
+        uint64_t num_columns = 0;
+        uint64_t num_rows = 0;
+        /// Memory provided for rows of the column being read.
+        bool memory_requested = false;
+        void* memory = nullptr;
+        Block block;
+    };
+
+    /// Reads the block, or the rest of it if reading has been
+    /// interrupted before.
+    bool ReadBlock(BlockState* state, CodedInputStream* input);
+
+    /// Reads the block of a data packet from data received so far
+    /// in asynchronous mode.
+    bool ReadReceivedBlock(CodedInputStream* input);
 
     bool ReceiveHello();
 
     /// Reads data packet form input stream.
-    bool ReceiveData(std::function<void(const Block&)> cb);
+    bool ReceiveData(CodedInputStream* input, std::function<void(const Block&)> cb);
 
     /// Reads exception packet form input stream.
-    bool ReceiveException(bool rethrow = false);
+    bool ReceiveException(CodedInputStream* input, bool rethrow = false);
+
+    /// Handles a packet received in asynchronous mode.
+    /// Returns true when the current query has finished.
+    bool HandleAsyncPacket(uint64_t server_packet, bool more);
+
+    /// Leaves the state of asynchronous query.
+    void FinishAsync();
 
     void WriteBlock(const Block& block, CodedOutputStream* output);
 
+    /// Completes statistics of the current query.
+    const QueryStats& FinishStats();
+
 private:
     /// In case of network errors tries to reconnect to server and
     /// call fuc several times.
@@ -140,18 +494,71 @@ private:
     const ClientOptions options_;
     QueryEvents* events_;
     int compression_ = CompressionState::Disable;
+    /// Insert query started by BeginInsert is in progress.
+    bool inserting_ = false;
+    /// Select query started by BeginSelect is in progress.
+    bool selecting_ = false;
+    Query select_query_;
+    /// Destination for the next block received by ReceiveBlock.
+    Block* select_block_ = nullptr;
+
+    struct ReusedColumn {
+        std::string type;
+        ColumnRef column;
+    };
+    /// Columns of the last received block, reused by the next one
+    /// when the current query allows it.
+    std::vector<ReusedColumn> reused_columns_;
+
+    /// Statistics of the current query.
+    QueryStats stats_;
+    /// The current query wants statistics.
+    bool wants_stats_ = false;
+    /// Resource counting allocations from the default one, created once
+    /// rather than for every block.
+    std::unique_ptr<CountingResource, ReleaseResource> counting_resource_;
+    std::chrono::steady_clock::time_point query_start_;
 
     SocketHolder socket_;
 
     SocketInput socket_input_;
+    MeasuredInput measured_input_;
     BufferedInput buffered_input_;
     CodedInputStream input_;
 
     SocketOutput socket_output_;
+    DeferredOutput deferred_output_;
+    MeasuredOutput measured_output_;
     BufferedOutput buffered_output_;
     CodedOutputStream output_;
 
     ServerInfo server_info_;
+
+    /// State of asynchronous mode.
+    enum class AsyncStage {
+        None,
+        Query,
+        InsertHeader,
+        InsertEnd,
+    };
+
+    AsyncStage async_stage_ = AsyncStage::None;
+    Query async_query_;
+    Block async_block_;
+    /// Received but not yet handled data.
+    Buffer pending_;
+    size_t pending_begin_ = 0;
+    size_t pending_end_ = 0;
+    /// Input of the packet being handled, while it is being handled.
+    ReceivedInput* received_ = nullptr;
+    /// Reading of the packet has run out of received data.
+    bool exhausted_ = false;
+    /// Block of the data packet being received.
+    BlockState receiving_;
+    /// Frames of the data packet decompressed so far, each of them once,
+    /// and the end of them in the packet.
+    Buffer decompressed_;
+    size_t frames_end_ = 0;
 };
 
 
@@ -160,10 +567,13 @@ Client::Impl::Impl(const ClientOptions& opts)
     , events_(nullptr)
     , socket_(-1)
     , socket_input_(socket_)
-    , buffered_input_(&socket_input_)
+    , measured_input_(&socket_input_)
+    , buffered_input_(&measured_input_, options_.input_buffer_size, options_.max_input_buffer_size)
     , input_(&buffered_input_)
     , socket_output_(socket_)
-    , buffered_output_(&socket_output_)
+    , deferred_output_(&socket_output_)
+    , measured_output_(&deferred_output_)
+    , buffered_output_(&measured_output_, options_.output_buffer_size)
     , output_(&buffered_output_)
 {
     for (unsigned int i = 0; ; ) {
@@ -188,13 +598,15 @@ Client::Impl::~Impl()
 { }
 
 void Client::Impl::ExecuteQuery(Query query) {
+    EnsureIdle();
+
     EnsureNull en(static_cast<QueryEvents*>(&query), &events_);
 
     if (options_.ping_before_query) {
         RetryGuard([this]() { Ping(); });
     }
 
-    SendQuery(query.GetText());
+    SendQuery(query.GetText(), query.GetSettings());
 
     while (ReceivePacket()) {
         ;
@@ -202,10 +614,6 @@ void Client::Impl::ExecuteQuery(Query query) {
 }
 
 void Client::Impl::Insert(const std::string& table_name, const Block& block) {
-    if (options_.ping_before_query) {
-        RetryGuard([this]() { Ping(); });
-    }
-
     std::vector<std::string> fields;
     fields.reserve(block.GetColumnCount());
 
@@ -214,17 +622,41 @@ void Client::Impl::Insert(const std::string& table_name, const Block& block) {
         fields.push_back(block.GetColumnName(i));
     }
 
-    std::stringstream fields_section;
+    BeginInsert(table_name, fields);
+    InsertData(block);
+    EndInsert();
+}
 
-    for (auto elem = fields.begin(); elem != fields.end(); ++elem) {
-        if (std::distance(elem, fields.end()) == 1) {
-            fields_section << *elem;
-        } else {
-            fields_section << *elem << ",";
+static std::string MakeInsertQuery(const std::string& table_name, const std::vector<std::string>& column_names) {
+    std::stringstream query;
+
+    query << "INSERT INTO " << table_name;
+
+    if (!column_names.empty()) {
+        query << " ( ";
+        for (auto elem = column_names.begin(); elem != column_names.end(); ++elem) {
+            if (std::distance(elem, column_names.end()) == 1) {
+                query << *elem;
+            } else {
+                query << *elem << ",";
+            }
         }
+        query << " )";
     }
 
-    SendQuery("INSERT INTO " + table_name + " ( " + fields_section.str() + " ) VALUES");
+    query << " VALUES";
+
+    return query.str();
+}
+
+void Client::Impl::BeginInsert(const std::string& table_name, const std::vector<std::string>& column_names) {
+    EnsureIdle();
+
+    if (options_.ping_before_query) {
+        RetryGuard([this]() { Ping(); });
+    }
+
+    SendQuery(MakeInsertQuery(table_name, column_names));
 
     uint64_t server_packet;
     // Receive data packet.
@@ -242,8 +674,36 @@ void Client::Impl::Insert(const std::string& table_name, const Block& block) {
         }
     }
 
-    // Send data.
-    SendData(block);
+    inserting_ = true;
+}
+
+void Client::Impl::InsertData(const Block& block) {
+    if (!inserting_) {
+        throw std::logic_error("insert is not started");
+    }
+
+    // Empty block is a marker of end of data,
+    // so it can't be sent in the middle of the stream.
+    if (block.GetRowCount() == 0) {
+        return;
+    }
+
+    try {
+        SendData(block);
+    } catch (...) {
+        // The connection is broken, so the insert can't be continued.
+        inserting_ = false;
+        throw;
+    }
+}
+
+void Client::Impl::EndInsert() {
+    if (!inserting_) {
+        throw std::logic_error("insert is not started");
+    }
+
+    inserting_ = false;
+
     // Send empty block as marker of
     // end of data.
     SendData(Block());
@@ -254,7 +714,97 @@ void Client::Impl::Insert(const std::string& table_name, const Block& block) {
     }
 }
 
+void Client::Impl::BeginSelect(const Query& query) {
+    EnsureIdle();
+
+    if (options_.ping_before_query) {
+        RetryGuard([this]() { Ping(); });
+    }
+
+    select_query_ = query;
+    events_ = &select_query_;
+    selecting_ = true;
+
+    try {
+        SendQuery(select_query_.GetText(), select_query_.GetSettings());
+    } catch (...) {
+        FinishSelect();
+        throw;
+    }
+}
+
+bool Client::Impl::ReceiveBlock(Block* block) {
+    if (!selecting_) {
+        throw std::logic_error("select is not started");
+    }
+
+    try {
+        while (true) {
+            uint64_t server_packet = 0;
+
+            *block = Block();
+            select_block_ = block;
+
+            const bool more = ReceivePacket(&server_packet);
+
+            select_block_ = nullptr;
+
+            if (!more) {
+                break;
+            }
+            // Skip header and other empty blocks.
+            if (server_packet == ServerCodes::Data && block->GetRowCount() > 0) {
+                return true;
+            }
+        }
+    } catch (...) {
+        select_block_ = nullptr;
+        FinishSelect();
+        throw;
+    }
+
+    FinishSelect();
+    return false;
+}
+
+void Client::Impl::EndSelect() {
+    if (!selecting_) {
+        return;
+    }
+
+    // Ask the server to stop sending data and
+    // discard everything sent so far.
+    Block discarded;
+
+    try {
+        SendCancel();
+
+        select_block_ = &discarded;
+        while (ReceivePacket()) {
+            ;
+        }
+    } catch (...) {
+        select_block_ = nullptr;
+        FinishSelect();
+        throw;
+    }
+
+    select_block_ = nullptr;
+    FinishSelect();
+}
+
+void Client::Impl::FinishSelect() {
+    selecting_ = false;
+
+    if (events_ == &select_query_) {
+        events_ = nullptr;
+    }
+    select_query_ = Query();
+}
+
 void Client::Impl::Ping() {
+    EnsureIdle();
+
     WireFormat::WriteUInt64(&output_, ClientCodes::Ping);
     output_.Flush();
 
@@ -267,7 +817,20 @@ void Client::Impl::Ping() {
 }
 
 void Client::Impl::ResetConnection() {
-    SocketHolder s(SocketConnect(NetworkAddress(options_.host, std::to_string(options_.port))));
+    inserting_ = false;
+    FinishSelect();
+    FinishAsync();
+    pending_begin_ = pending_end_ = 0;
+    receiving_ = BlockState();
+    decompressed_.clear();
+    frames_end_ = 0;
+    // Handshake is performed synchronously.
+    deferred_output_.Defer(false);
+    deferred_output_.Clear();
+
+    SocketHolder s(SocketConnect(NetworkAddress(options_.host, std::to_string(options_.port)),
+                                 options_.socket_receive_buffer_size,
+                                 options_.socket_send_buffer_size));
 
     if (s.Closed()) {
         throw std::system_error(errno, std::system_category());
@@ -278,6 +841,9 @@ void Client::Impl::ResetConnection() {
                           options_.tcp_keepalive_intvl.count(),
                           options_.tcp_keepalive_cnt);
     }
+    if (options_.tcp_nodelay) {
+        s.SetTcpNoDelay(true);
+    }
 
     socket_ = std::move(s);
     socket_input_ = SocketInput(socket_);
@@ -290,6 +856,188 @@ void Client::Impl::ResetConnection() {
     }
 }
 
+bool Client::Impl::IsIdle() const noexcept {
+    return !inserting_ && !selecting_ && async_stage_ == AsyncStage::None;
+}
+
+SOCKET Client::Impl::GetSocket() const {
+    return socket_;
+}
+
+void Client::Impl::EnsureIdle() const {
+    if (inserting_) {
+        throw std::logic_error("insert is in progress");
+    }
+    if (selecting_) {
+        throw std::logic_error("select is in progress");
+    }
+    if (async_stage_ != AsyncStage::None) {
+        throw std::logic_error("asynchronous query is in progress");
+    }
+}
+
+void Client::Impl::StartQuery(Query query) {
+    EnsureIdle();
+
+    async_query_ = std::move(query);
+    async_stage_ = AsyncStage::Query;
+    events_ = &async_query_;
+    deferred_output_.Defer(true);
+
+    SendQuery(async_query_.GetText(), async_query_.GetSettings());
+}
+
+void Client::Impl::StartInsert(const std::string& table_name, const Block& block) {
+    EnsureIdle();
+
+    std::vector<std::string> fields;
+    fields.reserve(block.GetColumnCount());
+
+    for (unsigned int i = 0; i < block.GetColumnCount(); i++) {
+        fields.push_back(block.GetColumnName(i));
+    }
+
+    async_block_ = block;
+    async_stage_ = AsyncStage::InsertHeader;
+    deferred_output_.Defer(true);
+
+    SendQuery(MakeInsertQuery(table_name, fields));
+}
+
+bool Client::Impl::ReceiveAvailable() {
+    static const size_t kReadSize = 64 * 1024;
+
+    // Take what the socket has at hand, until the amount of unhandled data
+    // has at least doubled, so a packet received by many parts is not read
+    // again after each of them, and memory is bounded by its size.
+    const size_t limit = std::max(kReadSize, 2 * (pending_end_ - pending_begin_));
+
+    while (pending_end_ - pending_begin_ < limit) {
+        if (pending_.size() - pending_end_ < kReadSize) {
+            if (pending_begin_ > 0) {
+                memmove(pending_.data(), pending_.data() + pending_begin_, pending_end_ - pending_begin_);
+                pending_end_ -= pending_begin_;
+                pending_begin_ = 0;
+            }
+            if (pending_.size() - pending_end_ < kReadSize) {
+                pending_.resize(std::max(pending_.size() * 2, pending_end_ + kReadSize));
+            }
+        }
+
+        const size_t space = pending_.size() - pending_end_;
+        const size_t received = measured_input_.Count([this, space] () {
+            return socket_input_.ReadAvailable(pending_.data() + pending_end_, space);
+        });
+
+        pending_end_ += received;
+
+        if (received < space) {
+            break;
+        }
+    }
+
+    struct ReceivedGuard {
+        ~ReceivedGuard() {
+            *ptr = nullptr;
+        }
+
+        ReceivedInput** ptr;
+    };
+
+    bool finished = false;
+
+    // Handle all completely received packets.  A packet is read by the same
+    // code as in synchronous mode; if received data ends within it, reading
+    // starts over when more data arrives, except for columns of a data block
+    // which have already been read.
+    while (!finished && pending_begin_ < pending_end_) {
+        exhausted_ = false;
+
+        ReceivedInput received(pending_.data() + pending_begin_, pending_end_ - pending_begin_, &exhausted_);
+        CodedInputStream input(&received);
+        uint64_t server_packet = 0;
+        bool more;
+
+        try {
+            ReceivedGuard guard{&received_};
+            received_ = &received;
+
+            more = ReceivePacket(&input, &server_packet);
+        } catch (const ServerException&) {
+            pending_begin_ += received.Position();
+            FinishAsync();
+            throw;
+        }
+
+        if (exhausted_) {
+            break;
+        }
+
+        pending_begin_ += received.Position();
+
+        finished = HandleAsyncPacket(server_packet, more);
+    }
+
+    if (pending_begin_ == pending_end_) {
+        pending_begin_ = pending_end_ = 0;
+    }
+
+    return finished;
+}
+
+bool Client::Impl::SendAvailable() {
+    return deferred_output_.SendAvailable();
+}
+
+bool Client::Impl::HandleAsyncPacket(uint64_t server_packet, bool more) {
+    switch (async_stage_) {
+        case AsyncStage::None:
+            throw std::runtime_error("unexpected packet " + std::to_string(server_packet));
+
+        case AsyncStage::Query:
+            if (!more) {
+                FinishAsync();
+                return true;
+            }
+            return false;
+
+        case AsyncStage::InsertHeader:
+            if (!more) {
+                FinishAsync();
+                throw std::runtime_error("fail to receive data packet");
+            }
+            if (server_packet == ServerCodes::Data) {
+                SendData(async_block_);
+                // Send empty block as marker of
+                // end of data.
+                SendData(Block());
+
+                async_block_ = Block();
+                async_stage_ = AsyncStage::InsertEnd;
+            }
+            return false;
+
+        case AsyncStage::InsertEnd:
+            if (!more) {
+                FinishAsync();
+                return true;
+            }
+            return false;
+    }
+
+    return false;
+}
+
+void Client::Impl::FinishAsync() {
+    if (events_ == &async_query_) {
+        events_ = nullptr;
+    }
+
+    async_stage_ = AsyncStage::None;
+    async_query_ = Query();
+    async_block_ = Block();
+}
+
 bool Client::Impl::Handshake() {
     if (!SendHello()) {
         return false;
@@ -301,9 +1049,13 @@ bool Client::Impl::Handshake() {
 }
 
 bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
+    return ReceivePacket(&input_, server_packet);
+}
+
+bool Client::Impl::ReceivePacket(CodedInputStream* input, uint64_t* server_packet) {
     uint64_t packet_type = 0;
 
-    if (!input_.ReadVarint64(&packet_type)) {
+    if (!input->ReadVarint64(&packet_type)) {
         return false;
     }
     if (server_packet) {
@@ -313,7 +1065,9 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
     switch (packet_type) {
     case ServerCodes::Data: {
         auto cb = [this] (const Block& block) {
-            if (events_) {
+            if (select_block_) {
+                *select_block_ = block;
+            } else if (events_) {
                 events_->OnData(block);
                 if (!events_->OnDataCancelable(block)) {
                     SendCancel();
@@ -321,36 +1075,39 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
             }
         };
 
-        if (!ReceiveData(cb)) {
+        if (!ReceiveData(input, cb)) {
+            if (received_ && exhausted_) {
+                return false;
+            }
             throw std::runtime_error("can't read data packet from input stream");
         }
         return true;
     }
 
     case ServerCodes::Exception: {
-        ReceiveException();
+        ReceiveException(input);
         return false;
     }
 
     case ServerCodes::ProfileInfo: {
         Profile profile;
 
-        if (!WireFormat::ReadUInt64(&input_, &profile.rows)) {
+        if (!WireFormat::ReadUInt64(input, &profile.rows)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &profile.blocks)) {
+        if (!WireFormat::ReadUInt64(input, &profile.blocks)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &profile.bytes)) {
+        if (!WireFormat::ReadUInt64(input, &profile.bytes)) {
             return false;
         }
-        if (!WireFormat::ReadFixed(&input_, &profile.applied_limit)) {
+        if (!WireFormat::ReadFixed(input, &profile.applied_limit)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &profile.rows_before_limit)) {
+        if (!WireFormat::ReadUInt64(input, &profile.rows_before_limit)) {
             return false;
         }
-        if (!WireFormat::ReadFixed(&input_, &profile.calculated_rows_before_limit)) {
+        if (!WireFormat::ReadFixed(input, &profile.calculated_rows_before_limit)) {
             return false;
         }
 
@@ -364,13 +1121,13 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
     case ServerCodes::Progress: {
         Progress info;
 
-        if (!WireFormat::ReadUInt64(&input_, &info.rows)) {
+        if (!WireFormat::ReadUInt64(input, &info.rows)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &info.bytes)) {
+        if (!WireFormat::ReadUInt64(input, &info.bytes)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(&input_, &info.total_rows)) {
+        if (!WireFormat::ReadUInt64(input, &info.total_rows)) {
             return false;
         }
 
@@ -388,6 +1145,9 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
     case ServerCodes::EndOfStream: {
         if (events_) {
             events_->OnFinish();
+            if (wants_stats_) {
+                events_->OnStats(FinishStats());
+            }
         }
         return false;
     }
@@ -399,7 +1159,10 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
             }
         };
 
-        if (!ReceiveData(cb)) {
+        if (!ReceiveData(input, cb)) {
+            if (received_ && exhausted_) {
+                return false;
+            }
             throw std::runtime_error("can't read data packet with totals from input stream");
         }
         return true;
@@ -412,7 +1175,10 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
             }
         };
 
-        if (!ReceiveData(cb)) {
+        if (!ReceiveData(input, cb)) {
+            if (received_ && exhausted_) {
+                return false;
+            }
             throw std::runtime_error("can't read data packet with extremes from input stream");
         }
         return true;
@@ -426,43 +1192,88 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
     return false;
 }
 
-bool Client::Impl::ReadBlock(Block* block, CodedInputStream* input) {
-    // Additional information about block.
-    if (REVISION >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
-        uint64_t num;
-        BlockInfo info;
+bool Client::Impl::ReadBlock(BlockState* state, CodedInputStream* input) {
+    Block* block = &state->block;
 
-        // BlockInfo
-        if (!WireFormat::ReadUInt64(input, &num)) {
-            return false;
-        }
-        if (!WireFormat::ReadFixed(input, &info.is_overflows)) {
-            return false;
-        }
-        if (!WireFormat::ReadUInt64(input, &num)) {
-            return false;
+    if (!state->started) {
+        // Additional information about block.
+        if (REVISION >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
+            uint64_t field_num;
+            BlockInfo info;
+
+            // Numbered fields of BlockInfo, ending with zero.
+            while (true) {
+                if (!WireFormat::ReadUInt64(input, &field_num)) {
+                    return false;
+                }
+                if (field_num == 0) {
+                    break;
+                } else if (field_num == 1) {
+                    if (!WireFormat::ReadFixed(input, &info.is_overflows)) {
+                        return false;
+                    }
+                } else if (field_num == 2) {
+                    if (!WireFormat::ReadFixed(input, &info.bucket_num)) {
+                        return false;
+                    }
+                } else {
+                    throw std::runtime_error("unknown field of block info " + std::to_string(field_num));
+                }
+            }
+
+            block->SetInfo(info);
         }
-        if (!WireFormat::ReadFixed(input, &info.bucket_num)) {
+
+        if (!WireFormat::ReadUInt64(input, &state->num_columns)) {
             return false;
         }
-        if (!WireFormat::ReadUInt64(input, &num)) {
+        if (!WireFormat::ReadUInt64(input, &state->num_rows)) {
             return false;
         }
 
-        // TODO use data
+        state->started = true;
+        if (state->source) {
+            state->resume = state->source->Position();
+        }
     }
 
-    uint64_t num_columns = 0;
-    uint64_t num_rows = 0;
+    const uint64_t num_rows = state->num_rows;
 
-    if (!WireFormat::ReadUInt64(input, &num_columns)) {
-        return false;
-    }
-    if (!WireFormat::ReadUInt64(input, &num_rows)) {
-        return false;
+    std::pmr::memory_resource* resource = events_
+        ? events_->MemoryResource() : std::pmr::get_default_resource();
+    const bool reuse = events_ && events_->ReuseColumns();
+    const bool count = wants_stats_ && resource == std::pmr::get_default_resource();
+
+    // Allocations from the default resource are counted in statistics.
+    if (count) {
+        if (!counting_resource_ || counting_resource_->Upstream() != resource) {
+            counting_resource_.reset(new CountingResource(resource));
+        }
+        resource = counting_resource_.get();
     }
 
-    for (size_t i = 0; i < num_columns; ++i) {
+    struct CountAllocations {
+        CountAllocations(CountingResource* resource, QueryStats* stats) noexcept
+            : resource_(resource)
+            , stats_(stats)
+            , allocations_(resource ? resource->Allocations() : 0)
+            , allocated_bytes_(resource ? resource->AllocatedBytes() : 0)
+        {
+        }
+        ~CountAllocations() {
+            if (resource_) {
+                stats_->allocations += resource_->Allocations() - allocations_;
+                stats_->allocated_bytes += resource_->AllocatedBytes() - allocated_bytes_;
+            }
+        }
+
+        CountingResource* const resource_;
+        QueryStats* const stats_;
+        const uint64_t allocations_;
+        const uint64_t allocated_bytes_;
+    } count_allocations(count ? counting_resource_.get() : nullptr, &stats_);
+
+    for (size_t i = block->GetColumnCount(); i < state->num_columns; ++i) {
         std::string name;
         std::string type;
 
@@ -473,12 +1284,59 @@ bool Client::Impl::ReadBlock(Block* block, CodedInputStream* input) {
             return false;
         }
 
-        if (ColumnRef col = CreateColumnByType(type)) {
-            if (num_rows && !col->Load(input, num_rows)) {
+        ColumnRef col;
+
+        if (reuse && i < reused_columns_.size() && reused_columns_[i].type == type) {
+            col = reused_columns_[i].column;
+            col->Clear();
+        } else {
+            col = CreateColumnByType(type, resource);
+
+            if (col && reuse) {
+                if (i < reused_columns_.size()) {
+                    reused_columns_[i] = ReusedColumn{type, col};
+                } else {
+                    reused_columns_.push_back(ReusedColumn{type, col});
+                }
+            }
+        }
+
+        if (col) {
+            const size_t size = num_rows * col->FixedRowSize();
+
+            // Rows of a fixed width are loaded once all of them have been
+            // received, other columns are loaded again from the beginning.
+            if (state->source && state->source->Avail() < size) {
+                exhausted_ = true;
+                return false;
+            }
+
+            if (num_rows && events_ && size && !state->memory_requested) {
+                state->memory = events_->OnColumnMemory(name, col->Type(), num_rows, size);
+                state->memory_requested = true;
+            }
+
+            if (state->memory) {
+                if (!col->LoadInto(input, num_rows, state->memory)) {
+                    if (state->source) {
+                        return false;
+                    }
+                    throw std::runtime_error("can't load");
+                }
+            } else if (num_rows && !col->Load(input, num_rows)) {
+                if (state->source) {
+                    return false;
+                }
                 throw std::runtime_error("can't load");
             }
 
             block->AppendColumn(name, col);
+
+            state->memory_requested = false;
+            state->memory = nullptr;
+            if (state->source) {
+                state->resume = state->source->Position();
+            }
         } else {
             throw std::runtime_error(std::string("unsupported column type: ") + type);
         }
@@ -487,53 +1345,167 @@ bool Client::Impl::ReadBlock(Block* block, CodedInputStream* input) {
     return true;
 }
 
-bool Client::Impl::ReceiveData(std::function<void(const Block&)> cb) {
-    Block block;
+bool Client::Impl::ReadReceivedBlock(CodedInputStream* input) {
+    BlockState* state = &receiving_;
+
+    if (compression_ != CompressionState::Enable) {
+        state->source = received_;
+
+        // Skip columns read by previous attempts.
+        if (state->resume > received_->Position() &&
+            !input->Skip(state->resume - received_->Position()))
+        {
+            return false;
+        }
+
+        return ReadBlock(state, input);
+    }
+
+    if (!frames_end_) {
+        frames_end_ = received_->Position();
+    }
+
+    // Frames are decompressed once each, as soon as they have been received.
+    // The end of the block is unknown until it has been read, so reading
+    // is attempted after each frame, and stops before the next packet.
+    while (true) {
+        ReceivedInput frames(decompressed_.data(), decompressed_.size(), &exhausted_);
+        CodedInputStream coded(&frames);
+
+        state->source = &frames;
+
+        if (!decompressed_.empty()) {
+            if (state->resume && !coded.Skip(state->resume)) {
+                return false;
+            }
+            if (ReadBlock(state, &coded)) {
+                break;
+            }
+            if (!exhausted_) {
+                return false;
+            }
+        }
+
+        const uint8_t* frame = pending_.data() + pending_begin_ + frames_end_;
+        const size_t avail = pending_end_ - pending_begin_ - frames_end_;
+
+        if (avail < CompressedInput::HEADER_SIZE || avail < CompressedInput::FrameSize(frame)) {
+            exhausted_ = true;
+            return false;
+        }
+
+        const size_t size = CompressedInput::FrameSize(frame);
+        ArrayInput array(frame, size);
+        CodedInputStream input(&array);
+        CompressedInput compressed(&input);
+        const void* ptr;
+        const size_t len = compressed.Next(&ptr, std::numeric_limits<size_t>::max());
+
+        if (!len) {
+            throw std::runtime_error("can't decompress frame");
+        }
+
+        decompressed_.insert(decompressed_.end(),
+            static_cast<const uint8_t*>(ptr), static_cast<const uint8_t*>(ptr) + len);
+        frames_end_ += size;
+        exhausted_ = false;
+
+        stats_.compressed_bytes += size;
+        stats_.uncompressed_bytes += len;
+        stats_.decompress_time += compressed.DecompressTime();
+    }
+
+    // The block ends with the last frame.
+    return input->Skip(frames_end_ - received_->Position());
+}
+
+bool Client::Impl::ReceiveData(CodedInputStream* input, std::function<void(const Block&)> cb) {
     std::string table_name;
 
     // Read name of a table.
-    if (!WireFormat::ReadString(&input_, &table_name)) {
+    if (!WireFormat::ReadString(input, &table_name)) {
         return false;
     }
 
-    if (compression_ == CompressionState::Enable) {
-        CompressedInput compressed(&input_);
+    std::chrono::steady_clock::time_point start;
+    if (wants_stats_) {
+        start = std::chrono::steady_clock::now();
+    }
+    const auto read_time = stats_.read_time;
+
+    BlockState state;
+
+    if (received_) {
+        if (!ReadReceivedBlock(input)) {
+            return false;
+        }
+
+        state = std::move(receiving_);
+        state.source = nullptr;
+
+        receiving_ = BlockState();
+        decompressed_.clear();
+        frames_end_ = 0;
+    } else if (compression_ == CompressionState::Enable) {
+        CompressedInput compressed(input);
         CodedInputStream coded(&compressed);
 
-        if (!ReadBlock(&block, &coded)) {
+        if (!ReadBlock(&state, &coded)) {
             return false;
         }
+
+        stats_.compressed_bytes += compressed.CompressedBytes();
+        stats_.uncompressed_bytes += compressed.DecompressedBytes();
+        stats_.decompress_time += compressed.DecompressTime();
+        stats_.load_time -= compressed.DecompressTime();
     } else {
-        if (!ReadBlock(&block, &input_)) {
+        if (!ReadBlock(&state, input)) {
             return false;
         }
     }
 
+    const Block& block = state.block;
+
+    if (!wants_stats_) {
+        cb(block);
+        return true;
+    }
+
+    const auto loaded = std::chrono::steady_clock::now();
+
+    stats_.load_time += (loaded - start) - (stats_.read_time - read_time);
+    if (block.GetRowCount()) {
+        stats_.blocks += 1;
+        stats_.rows += block.GetRowCount();
+    }
+
     cb(block);
 
+    stats_.callback_time += std::chrono::steady_clock::now() - loaded;
+
     return true;
 }
 
-bool Client::Impl::ReceiveException(bool rethrow) {
+bool Client::Impl::ReceiveException(CodedInputStream* input, bool rethrow) {
     std::unique_ptr<Exception> e(new Exception);
     Exception* current = e.get();
 
     do {
         bool has_nested = false;
 
-        if (!WireFormat::ReadFixed(&input_, &current->code)) {
+        if (!WireFormat::ReadFixed(input, &current->code)) {
             return false;
         }
-        if (!WireFormat::ReadString(&input_, &current->name)) {
+        if (!WireFormat::ReadString(input, &current->name)) {
             return false;
         }
-        if (!WireFormat::ReadString(&input_, &current->display_text)) {
+        if (!WireFormat::ReadString(input, &current->display_text)) {
             return false;
         }
-        if (!WireFormat::ReadString(&input_, &current->stack_trace)) {
+        if (!WireFormat::ReadString(input, &current->stack_trace)) {
             return false;
         }
-        if (!WireFormat::ReadFixed(&input_, &has_nested)) {
+        if (!WireFormat::ReadFixed(input, &has_nested)) {
             return false;
         }
 
@@ -547,6 +1519,9 @@ bool Client::Impl::ReceiveException(bool rethrow) {
 
     if (events_) {
         events_->OnServerException(*e);
+        if (wants_stats_) {
+            events_->OnStats(FinishStats());
+        }
     }
 
     if (rethrow || options_.rethrow_exceptions) {
@@ -561,7 +1536,19 @@ void Client::Impl::SendCancel() {
     output_.Flush();
 }
 
-void Client::Impl::SendQuery(const std::string& query) {
+void Client::Impl::SendQuery(const std::string& query, const QuerySettings& settings) {
+    // Columns may belong to the memory resource of the previous query.
+    reused_columns_.clear();
+
+    // Statistics are measured only if the query wants them.
+    wants_stats_ = events_ && events_->WantsStats();
+    if (wants_stats_) {
+        stats_ = QueryStats();
+        query_start_ = std::chrono::steady_clock::now();
+    }
+    measured_input_.Measure(wants_stats_ ? &stats_ : nullptr);
+    measured_output_.Measure(wants_stats_ ? &stats_ : nullptr);
+
     WireFormat::WriteUInt64(&output_, ClientCodes::Query);
     WireFormat::WriteString(&output_, std::string());
 
@@ -598,10 +1585,31 @@ void Client::Impl::SendQuery(const std::string& query) {
         }
     }
 
-    /// Per query settings.
-    //if (settings)
-    //    settings->serialize(*out);
-    //else
+    /// Per query settings: those of the client, overridden by the query.
+    QuerySettings all = options_.settings;
+
+    for (const auto& setting : settings.Values()) {
+        std::visit([&] (const auto& value) { all.Set(setting.first, value); }, setting.second);
+    }
+    if (compression_ == CompressionState::Enable &&
+        options_.compression_method == CompressionMethod::ZSTD &&
+        !all.Get("network_compression_method"))
+    {
+        // Ask the server to compress sent data with the same method.
+        all.Set("network_compression_method", "ZSTD");
+    }
+
+    // Before DBMS_MIN_REVISION_WITH_SETTINGS_SERIALIZED_AS_STRINGS numeric
+    // settings are sent as varints and the others as strings.
+    for (const auto& setting : all.Values()) {
+        WireFormat::WriteString(&output_, setting.first);
+
+        if (auto number = std::get_if<uint64_t>(&setting.second)) {
+            WireFormat::WriteUInt64(&output_, *number);
+        } else {
+            WireFormat::WriteString(&output_, std::get<std::string>(setting.second));
+        }
+    }
     WireFormat::WriteString(&output_, std::string());
 
     WireFormat::WriteUInt64(&output_, Stages::Complete);
@@ -615,6 +1623,11 @@ void Client::Impl::SendQuery(const std::string& query) {
 }
 
 
+const QueryStats& Client::Impl::FinishStats() {
+    stats_.total_time = std::chrono::steady_clock::now() - query_start_;
+    return stats_;
+}
+
 void Client::Impl::WriteBlock(const Block& block, CodedOutputStream* output) {
     // Additional information about block.
     if (server_info_.revision >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
@@ -644,43 +1657,18 @@ void Client::Impl::SendData(const Block& block) {
     }
 
     if (compression_ == CompressionState::Enable) {
-        switch (options_.compression_method) {
-            case CompressionMethod::None: {
-                assert(false);
-                break;
-            }
-
-            case CompressionMethod::LZ4: {
-                Buffer tmp;
-                // Serialize block's data
-                {
-                    BufferOutput out(&tmp);
-                    CodedOutputStream coded(&out);
-                    WriteBlock(block, &coded);
-                }
-                // Reserver space for data
-                Buffer buf;
-                buf.resize(9 + LZ4_compressBound(tmp.size()));
-
-                // Compress data
-                int size = LZ4_compress((const char*)tmp.data(), (char*)buf.data() + 9, tmp.size());
-                buf.resize(9 + size);
-
-                // Fill header
-                uint8_t* p = buf.data();
-                // Compression method
-                WriteUnaligned(p, (uint8_t)0x82); p += 1;
-                // Compressed data size with header
-                WriteUnaligned(p, (uint32_t)buf.size()); p += 4;
-                // Original data size
-                WriteUnaligned(p, (uint32_t)tmp.size());
-
-                WireFormat::WriteFixed(&output_, CityHash128(
-                                    (const char*)buf.data(), buf.size()));
-                WireFormat::WriteBytes(&output_, buf.data(), buf.size());
-                break;
-            }
-        }
+        assert(options_.compression_method != CompressionMethod::None);
+
+        // Serialized data is compressed and sent frame by frame.
+        CompressedOutput compressed(&buffered_output_,
+            options_.compression_method == CompressionMethod::ZSTD
+                ? CompressionMethodByte::ZSTD
+                : CompressionMethodByte::LZ4,
+            options_.zstd_compression_level);
+        CodedOutputStream coded(&compressed);
+
+        WriteBlock(block, &coded);
+        compressed.Flush();
     } else {
         WriteBlock(block, &output_);
     }
@@ -744,7 +1732,7 @@ bool Client::Impl::ReceiveHello() {
 
         return true;
     } else if (packet_type == ServerCodes::Exception) {
-        ReceiveException(true);
+        ReceiveException(&input_, true);
         return false;
     }
 
@@ -802,6 +1790,30 @@ void Client::Insert(const std::string& table_name, const Block& block) {
     impl_->Insert(table_name, block);
 }
 
+void Client::BeginInsert(const std::string& table_name, const std::vector<std::string>& column_names) {
+    impl_->BeginInsert(table_name, column_names);
+}
+
+void Client::InsertData(const Block& block) {
+    impl_->InsertData(block);
+}
+
+void Client::EndInsert() {
+    impl_->EndInsert();
+}
+
+void Client::BeginSelect(const Query& query) {
+    impl_->BeginSelect(query);
+}
+
+bool Client::ReceiveBlock(Block* block) {
+    return impl_->ReceiveBlock(block);
+}
+
+void Client::EndSelect() {
+    impl_->EndSelect();
+}
+
 void Client::Ping() {
     impl_->Ping();
 }
@@ -810,4 +1822,32 @@ void Client::ResetConnection() {
     impl_->ResetConnection();
 }
 
+bool Client::IsIdle() const noexcept {
+    return impl_->IsIdle();
+}
+
+#if defined(_unix_)
+
+int Client::GetSocket() const {
+    return impl_->GetSocket();
+}
+
+void Client::StartQuery(Query query) {
+    impl_->StartQuery(std::move(query));
+}
+
+void Client::StartInsert(const std::string& table_name, const Block& block) {
+    impl_->StartInsert(table_name, block);
+}
+
+bool Client::ReceiveAvailable() {
+    return impl_->ReceiveAvailable();
+}
+
+bool Client::SendAvailable() {
+    return impl_->SendAvailable();
+}
+
+#endif
+
 }
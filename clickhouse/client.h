@@ -3,6 +3,8 @@
 #include "query.h"
 #include "exceptions.h"
 
+#include "base/platform.h"
+
 #include "columns/array.h"
 #include "columns/date.h"
 #include "columns/decimal.h"
@@ -19,6 +21,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace clickhouse {
 
@@ -26,6 +29,7 @@ namespace clickhouse {
 enum class CompressionMethod {
     None    = -1,
     LZ4     =  1,
+    ZSTD    =  2,
 };
 
 struct ClientOptions {
@@ -60,8 +64,29 @@ struct ClientOptions {
     /// Amount of time to wait before next retry.
     DECLARE_FIELD(retry_timeout, std::chrono::seconds, SetRetryTimeout, std::chrono::seconds(5));
 
+    /// Settings sent with every query.  Settings of a query override
+    /// settings of the client with the same names.
+    DECLARE_FIELD(settings, QuerySettings, SetSettings, QuerySettings());
+
     /// Compression method.
     DECLARE_FIELD(compression_method, CompressionMethod, SetCompressionMethod, CompressionMethod::None);
+    /// Level of ZSTD compression of sent data.  Higher levels trade
+    /// CPU time for fewer bytes on the wire.
+    DECLARE_FIELD(zstd_compression_level, int, SetZstdCompressionLevel, 1);
+
+    /// Initial size of the buffer for data received from the server.
+    DECLARE_FIELD(input_buffer_size, size_t, SetInputBufferSize, 64 * 1024);
+    /// The input buffer grows up to this size while large results keep
+    /// filling it completely.  Set it equal to input_buffer_size to keep
+    /// the buffer size fixed.
+    DECLARE_FIELD(max_input_buffer_size, size_t, SetMaxInputBufferSize, 1024 * 1024);
+    /// Size of the buffer for data sent to the server.
+    DECLARE_FIELD(output_buffer_size, size_t, SetOutputBufferSize, 64 * 1024);
+
+    /// Sizes of kernel buffers of the socket (SO_RCVBUF and SO_SNDBUF).
+    /// Zero keeps the system defaults.
+    DECLARE_FIELD(socket_receive_buffer_size, int, SetSocketReceiveBufferSize, 0);
+    DECLARE_FIELD(socket_send_buffer_size, int, SetSocketSendBufferSize, 0);
 
     /// TCP Keep alive options
     DECLARE_FIELD(tcp_keepalive, bool, TcpKeepAlive, false);
@@ -69,11 +94,18 @@ struct ClientOptions {
     DECLARE_FIELD(tcp_keepalive_intvl, std::chrono::seconds, SetTcpKeepAliveInterval, std::chrono::seconds(5));
     DECLARE_FIELD(tcp_keepalive_cnt, unsigned int, SetTcpKeepAliveCount, 3);
 
+    /// Disable Nagle's algorithm on the socket (TCP_NODELAY).  Otherwise
+    /// a small query or block sent after another write may wait for
+    /// the delayed acknowledgement of the server, up to 40 ms on Linux.
+    DECLARE_FIELD(tcp_nodelay, bool, TcpNoDelay, false);
+
 #undef DECLARE_FIELD
 };
 
 std::ostream& operator<<(std::ostream& os, const ClientOptions& options);
 
+class AsyncClient;
+
 /**
  *
  */
@@ -96,16 +128,63 @@ public:
     /// Alias for Execute.
     void Select(const Query& query);
 
+    /// Starts a select query whose result is pulled block by block with
+    /// ReceiveBlock().  The next data packet is read from the socket only
+    /// when the caller asks for it, so a slow consumer naturally throttles
+    /// the server.  Handlers of the query other than data ones are still
+    /// invoked while blocks are being received.
+    void BeginSelect(const Query& query);
+
+    /// Receives the next non-empty block of the query started by
+    /// BeginSelect().  Returns false when the result has been exhausted.
+    bool ReceiveBlock(Block* block);
+
+    /// Cancels the query started by BeginSelect() if its result has not
+    /// been exhausted yet.
+    void EndSelect();
+
     /// Intends for insert block of data into a table \p table_name.
     void Insert(const std::string& table_name, const Block& block);
 
+    /// Starts streaming insertion into a table \p table_name.  Only columns
+    /// listed in \p column_names will be filled, all columns of the table
+    /// are expected if the list is empty.  Blocks of data are sent with
+    /// InsertData() and the insertion must be completed with EndInsert().
+    void BeginInsert(const std::string& table_name,
+                     const std::vector<std::string>& column_names = {});
+
+    /// Sends one more block of data within the insertion started by
+    /// BeginInsert().  Blocks are streamed back-to-back without waiting
+    /// for any response from the server.
+    void InsertData(const Block& block);
+
+    /// Completes the insertion started by BeginInsert() and waits for
+    /// the server to acknowledge all sent data.
+    void EndInsert();
+
     /// Ping server for aliveness.
     void Ping();
 
     /// Reset connection with initial params.
     void ResetConnection();
 
+    /// Returns false while a query started with BeginSelect(), BeginInsert()
+    /// or by an AsyncClient has not been completed.
+    bool IsIdle() const noexcept;
+
 private:
+    friend class AsyncClient;
+
+#if defined(_unix_)
+    /// Asynchronous mode, used by AsyncClient.  The connection is driven
+    /// by an event loop, see the methods of Client::Impl of the same names.
+    int GetSocket() const;
+    void StartQuery(Query query);
+    void StartInsert(const std::string& table_name, const Block& block);
+    bool ReceiveAvailable();
+    bool SendAvailable();
+#endif
+
     ClientOptions options_;
 
     class Impl;
@@ -0,0 +1,244 @@
+#include "client_pool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace clickhouse {
+
+class ClientPool::Impl {
+    struct Entry {
+        std::unique_ptr<Client> client;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+public:
+    explicit Impl(const ClientPoolOptions& options);
+
+    /// Takes a free connection, waiting up to acquire_timeout for it.
+    std::unique_ptr<Client> Take();
+
+    /// Count of connections ready to be acquired.
+    size_t Idle() const;
+
+    /// Gives the connection of a lease back to the pool.
+    void Release(std::unique_ptr<Client> client, bool broken) noexcept;
+
+    /// Pings idle connections and replaces the broken ones.
+    void MaintenanceLoop();
+
+    /// Stops maintenance and closes idle connections.  Connections
+    /// released afterwards are closed too.
+    void Stop() noexcept;
+
+private:
+    const ClientPoolOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_cond_;
+    std::condition_variable maintenance_cond_;
+
+    std::deque<Entry> idle_;
+    /// Count of connections which have to be (re)created.
+    size_t missing_ = 0;
+    bool stopped_ = false;
+};
+
+ClientPool::Impl::Impl(const ClientPoolOptions& options)
+    : options_(options)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < options_.size; ++i) {
+        idle_.push_back(Entry{std::make_unique<Client>(options_.client_options), now});
+    }
+}
+
+std::unique_ptr<Client> ClientPool::Impl::Take() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const bool ready = idle_cond_.wait_for(lock, options_.acquire_timeout,
+        [this] () { return !idle_.empty(); });
+
+    if (!ready) {
+        throw std::runtime_error("no free connection in the pool");
+    }
+
+    // Take the most recently used connection, so rarely used ones
+    // become idle long enough to be checked in the background.
+    std::unique_ptr<Client> client = std::move(idle_.back().client);
+    idle_.pop_back();
+
+    return client;
+}
+
+size_t ClientPool::Impl::Idle() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return idle_.size();
+}
+
+void ClientPool::Impl::Release(std::unique_ptr<Client> client, bool broken) noexcept {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+
+        if (!broken && !stopped_) {
+            idle_.push_back(Entry{std::move(client), std::chrono::steady_clock::now()});
+        } else if (!stopped_) {
+            ++missing_;
+        }
+    }
+
+    if (client) {
+        // Close the connection outside of the lock.
+        client.reset();
+        maintenance_cond_.notify_one();
+    } else {
+        idle_cond_.notify_one();
+    }
+}
+
+void ClientPool::Impl::Stop() noexcept {
+    std::deque<Entry> idle;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopped_ = true;
+        idle.swap(idle_);
+    }
+
+    maintenance_cond_.notify_all();
+}
+
+void ClientPool::Impl::MaintenanceLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopped_) {
+        maintenance_cond_.wait_for(lock, options_.ping_interval,
+            [this] () { return stopped_ || missing_ > 0; });
+
+        if (stopped_) {
+            break;
+        }
+
+        // Take connections which were idle for too long out of the pool.
+        const auto deadline = std::chrono::steady_clock::now() - options_.ping_interval;
+        std::vector<Entry> stale;
+
+        for (auto it = idle_.begin(); it != idle_.end(); ) {
+            if (it->last_used <= deadline) {
+                stale.push_back(std::move(*it));
+                it = idle_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        const size_t missing = missing_;
+
+        lock.unlock();
+
+        for (auto& entry : stale) {
+            try {
+                entry.client->Ping();
+                entry.last_used = std::chrono::steady_clock::now();
+            } catch (const std::exception&) {
+                entry.client.reset();
+            }
+        }
+
+        std::vector<Entry> created;
+        for (size_t i = 0; i < missing; ++i) {
+            try {
+                created.push_back(Entry{
+                    std::make_unique<Client>(options_.client_options),
+                    std::chrono::steady_clock::now()});
+            } catch (const std::exception&) {
+                break;
+            }
+        }
+
+        lock.lock();
+
+        // Connections are dropped if the pool has been stopped meanwhile.
+        if (stopped_) {
+            break;
+        }
+
+        for (auto& entry : stale) {
+            if (entry.client) {
+                idle_.push_back(std::move(entry));
+            } else {
+                ++missing_;
+            }
+        }
+        for (auto& entry : created) {
+            idle_.push_back(std::move(entry));
+        }
+        missing_ -= created.size();
+
+        idle_cond_.notify_all();
+
+        // Server is unreachable, do not try to reconnect in a tight loop.
+        if (created.size() < missing) {
+            maintenance_cond_.wait_for(lock, options_.client_options.retry_timeout,
+                [this] () { return stopped_; });
+        }
+    }
+}
+
+
+ClientPool::Lease::Lease(std::shared_ptr<Impl> pool, std::unique_ptr<Client> client)
+    : pool_(std::move(pool))
+    , client_(std::move(client))
+    , uncaught_exceptions_(std::uncaught_exceptions())
+{
+}
+
+ClientPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::move(other.pool_))
+    , client_(std::move(other.client_))
+    , uncaught_exceptions_(other.uncaught_exceptions_)
+    , broken_(other.broken_)
+{
+}
+
+ClientPool::Lease::~Lease() {
+    if (pool_ && client_) {
+        const bool unwinding = std::uncaught_exceptions() > uncaught_exceptions_;
+        // A connection in the middle of a query can't be reused.
+        const bool broken = broken_ || unwinding || !client_->IsIdle();
+
+        pool_->Release(std::move(client_), broken);
+    }
+}
+
+void ClientPool::Lease::Invalidate() noexcept {
+    broken_ = true;
+}
+
+
+ClientPool::ClientPool(const ClientPoolOptions& options)
+    : impl_(std::make_shared<Impl>(options))
+{
+    Impl* impl = impl_.get();
+
+    maintenance_ = std::thread([impl] () { impl->MaintenanceLoop(); });
+}
+
+ClientPool::~ClientPool() {
+    impl_->Stop();
+    maintenance_.join();
+}
+
+ClientPool::Lease ClientPool::Acquire() {
+    return Lease(impl_, impl_->Take());
+}
+
+size_t ClientPool::Idle() const {
+    return impl_->Idle();
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "client.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace clickhouse {
+
+struct ClientPoolOptions {
+#define DECLARE_FIELD(name, type, setter, default) \
+    type name = default; \
+    inline ClientPoolOptions& setter(const type& value) { \
+        name = value; \
+        return *this; \
+    }
+
+    /// Options of every connection in the pool.
+    DECLARE_FIELD(client_options, ClientOptions, SetClientOptions, ClientOptions());
+
+    /// Count of connections kept by the pool.
+    DECLARE_FIELD(size, size_t, SetSize, 4);
+
+    /// Connections which have not been used for this amount of time are
+    /// checked with Ping() in the background and replaced if broken.
+    DECLARE_FIELD(ping_interval, std::chrono::seconds, SetPingInterval, std::chrono::seconds(30));
+
+    /// Maximum amount of time to wait for a free connection in Acquire().
+    DECLARE_FIELD(acquire_timeout, std::chrono::milliseconds, SetAcquireTimeout, std::chrono::seconds(10));
+
+#undef DECLARE_FIELD
+};
+
+/**
+ * A pool of warm, handshaken connections to the same server.
+ *
+ * Each connection is used by one thread at a time: Acquire() hands out
+ * a lease which returns the connection back to the pool on destruction.
+ * A background thread pings idle connections and replaces broken ones,
+ * so reconnects do not happen on the request path.
+ *
+ * Leases share the state of the pool, so they may outlive it: the
+ * connection of a lease released after destruction of the pool is closed.
+ */
+class ClientPool {
+    class Impl;
+
+public:
+    /// Exclusive ownership of a pooled connection.
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        ~Lease();
+
+        inline Client* operator -> () const noexcept {
+            return client_.get();
+        }
+
+        inline Client& operator * () const noexcept {
+            return *client_;
+        }
+
+        /// Marks the connection as broken, so it will be replaced instead
+        /// of being returned to the pool.  A lease destroyed by an exception
+        /// or while a query is still in progress on the connection is
+        /// considered broken as well because the state of the connection
+        /// is unknown.
+        void Invalidate() noexcept;
+
+    private:
+        Lease(std::shared_ptr<Impl> pool, std::unique_ptr<Client> client);
+
+        Lease(const Lease&) = delete;
+        Lease& operator = (const Lease&) = delete;
+        Lease& operator = (Lease&&) = delete;
+
+        friend class ClientPool;
+
+        std::shared_ptr<Impl> pool_;
+        std::unique_ptr<Client> client_;
+        int uncaught_exceptions_;
+        bool broken_ = false;
+    };
+
+public:
+    explicit ClientPool(const ClientPoolOptions& options);
+    ~ClientPool();
+
+    /// Takes a free connection from the pool.  Waits up to acquire_timeout
+    /// for a connection to become available.
+    Lease Acquire();
+
+    /// Count of connections ready to be acquired.
+    size_t Idle() const;
+
+private:
+    ClientPool(const ClientPool&) = delete;
+    ClientPool& operator = (const ClientPool&) = delete;
+
+private:
+    std::shared_ptr<Impl> impl_;
+    std::thread maintenance_;
+};
+
+}
@@ -1,12 +1,14 @@
 #include "array.h"
+
+#include <algorithm>
 #include <stdexcept>
 
 namespace clickhouse {
 
-ColumnArray::ColumnArray(ColumnRef data)
+ColumnArray::ColumnArray(ColumnRef data, std::pmr::memory_resource* resource)
     : Column(Type::CreateArray(data->Type()))
     , data_(data)
-    , offsets_(std::make_shared<ColumnUInt64>())
+    , offsets_(std::make_shared<ColumnUInt64>(resource))
 {
 }
 
@@ -31,12 +33,17 @@ ColumnRef ColumnArray::GetAsColumn(size_t n) const {
 }
 
 ColumnRef ColumnArray::Slice(size_t begin, size_t size) {
-    auto result = std::make_shared<ColumnArray>(GetAsColumn(begin));
-    result->OffsetsIncrease(1);
+    size = (begin < Size()) ? std::min(size, Size() - begin) : 0;
+
+    const size_t first = size ? GetOffset(begin) : 0;
+    const size_t last = size ? (*offsets_)[begin + size - 1] : 0;
+
+    auto result = std::make_shared<ColumnArray>(data_->Slice(first, last - first));
 
-    for (size_t i = 1; i < size; i++)
-    {
-        result->Append(std::make_shared<ColumnArray>(GetAsColumn(begin + i)));
+    // Keep offsets in the memory resource of the current column.
+    result->offsets_ = offsets_->Slice(0, 0)->As<ColumnUInt64>();
+    for (size_t i = begin; i < begin + size; ++i) {
+        result->offsets_->Append((*offsets_)[i] - first);
     }
 
     return result;
@@ -48,9 +55,13 @@ void ColumnArray::Append(ColumnRef column) {
             return;
         }
 
+        const size_t base = Size() ? (*offsets_)[Size() - 1] : 0;
+
         for (size_t i = 0; i < col->Size(); ++i) {
-            AppendAsColumn(col->GetAsColumn(i));
+            offsets_->Append(base + (*col->offsets_)[i]);
         }
+
+        data_->Append(col->data_);
     }
 }
 
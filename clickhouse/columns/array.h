@@ -9,7 +9,7 @@ namespace clickhouse {
  */
 class ColumnArray : public Column {
 public:
-    ColumnArray(ColumnRef data);
+    ColumnArray(ColumnRef data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Converts input column to array and appends
     /// as one row to the current column.
@@ -4,6 +4,8 @@
 #include "../base/coded.h"
 #include "../types/types.h"
 
+#include <memory_resource>
+
 namespace clickhouse {
 
 using ColumnRef = std::shared_ptr<class Column>;
@@ -55,6 +57,18 @@ public:
     /// Makes slice of the current column.
     virtual ColumnRef Slice(size_t begin, size_t len) = 0;
 
+    /// Returns size of a row in bytes if the column can keep its rows in
+    /// memory provided by the application, zero otherwise.
+    virtual size_t FixedRowSize() const { return 0; }
+
+    /// Loads rows into \p memory, which must hold rows * FixedRowSize() bytes
+    /// and stay valid as long as the column refers to it.  Any modification
+    /// of the column copies the rows into memory of the column.
+    virtual bool LoadInto(CodedInputStream* input, size_t rows, void* memory) {
+        (void)input; (void)rows; (void)memory;
+        return false;
+    }
+
 protected:
     TypeRef type_;
 };
@@ -2,9 +2,9 @@
 
 namespace clickhouse {
 
-ColumnDate::ColumnDate()
+ColumnDate::ColumnDate(std::pmr::memory_resource* resource)
     : Column(Type::CreateDate())
-    , data_(std::make_shared<ColumnUInt16>())
+    , data_(std::make_shared<ColumnUInt16>(resource))
 {
 }
 
@@ -30,6 +30,14 @@ bool ColumnDate::Load(CodedInputStream* input, size_t rows) {
     return data_->Load(input, rows);
 }
 
+bool ColumnDate::LoadInto(CodedInputStream* input, size_t rows, void* memory) {
+    return data_->LoadInto(input, rows, memory);
+}
+
+size_t ColumnDate::FixedRowSize() const {
+    return data_->FixedRowSize();
+}
+
 void ColumnDate::Save(CodedOutputStream* output) {
     data_->Save(output);
 }
@@ -39,24 +47,23 @@ size_t ColumnDate::Size() const {
 }
 
 ColumnRef ColumnDate::Slice(size_t begin, size_t len) {
-    auto col = data_->Slice(begin, len)->As<ColumnUInt16>();
     auto result = std::make_shared<ColumnDate>();
 
-    result->data_->Append(col);
+    result->data_ = data_->Slice(begin, len)->As<ColumnUInt16>();
 
     return result;
 }
 
 
-ColumnDateTime::ColumnDateTime()
+ColumnDateTime::ColumnDateTime(std::pmr::memory_resource* resource)
     : Column(Type::CreateDateTime())
-    , data_(std::make_shared<ColumnUInt32>())
+    , data_(std::make_shared<ColumnUInt32>(resource))
 {
 }
 
-ColumnDateTime::ColumnDateTime(std::string timezone)
+ColumnDateTime::ColumnDateTime(std::string timezone, std::pmr::memory_resource* resource)
     : Column(Type::CreateDateTime(std::move(timezone)))
-    , data_(std::make_shared<ColumnUInt32>())
+    , data_(std::make_shared<ColumnUInt32>(resource))
 {
 }
 
@@ -82,6 +89,14 @@ bool ColumnDateTime::Load(CodedInputStream* input, size_t rows) {
     return data_->Load(input, rows);
 }
 
+bool ColumnDateTime::LoadInto(CodedInputStream* input, size_t rows, void* memory) {
+    return data_->LoadInto(input, rows, memory);
+}
+
+size_t ColumnDateTime::FixedRowSize() const {
+    return data_->FixedRowSize();
+}
+
 void ColumnDateTime::Save(CodedOutputStream* output) {
     data_->Save(output);
 }
@@ -95,24 +110,23 @@ void ColumnDateTime::Clear() {
 }
 
 ColumnRef ColumnDateTime::Slice(size_t begin, size_t len) {
-    auto col = data_->Slice(begin, len)->As<ColumnUInt32>();
     auto result = std::make_shared<ColumnDateTime>();
 
-    result->data_->Append(col);
+    result->data_ = data_->Slice(begin, len)->As<ColumnUInt32>();
 
     return result;
 }
 
 
-ColumnDateTime64::ColumnDateTime64(size_t precision)
+ColumnDateTime64::ColumnDateTime64(size_t precision, std::pmr::memory_resource* resource)
     : Column(Type::CreateDateTime64(precision))
-    , data_(std::make_shared<ColumnUInt64>())
+    , data_(std::make_shared<ColumnUInt64>(resource))
 {
 }
 
-ColumnDateTime64::ColumnDateTime64(size_t precision, std::string timezone)
+ColumnDateTime64::ColumnDateTime64(size_t precision, std::string timezone, std::pmr::memory_resource* resource)
     : Column(Type::CreateDateTime64(precision, std::move(timezone)))
-    , data_(std::make_shared<ColumnUInt64>())
+    , data_(std::make_shared<ColumnUInt64>(resource))
 {
 }
 
@@ -144,6 +158,14 @@ bool ColumnDateTime64::Load(CodedInputStream* input, size_t rows) {
     return data_->Load(input, rows);
 }
 
+bool ColumnDateTime64::LoadInto(CodedInputStream* input, size_t rows, void* memory) {
+    return data_->LoadInto(input, rows, memory);
+}
+
+size_t ColumnDateTime64::FixedRowSize() const {
+    return data_->FixedRowSize();
+}
+
 void ColumnDateTime64::Save(CodedOutputStream* output) {
     data_->Save(output);
 }
@@ -9,7 +9,7 @@ namespace clickhouse {
 /** */
 class ColumnDate : public Column {
 public:
-    ColumnDate();
+    explicit ColumnDate(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const std::time_t& value);
@@ -36,6 +36,11 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    size_t FixedRowSize() const override;
+
+    /// Loads rows into memory owned by the application without copying.
+    bool LoadInto(CodedInputStream* input, size_t rows, void* memory) override;
+
 private:
     std::shared_ptr<ColumnUInt16> data_;
 };
@@ -43,8 +48,8 @@ private:
 /** */
 class ColumnDateTime : public Column {
 public:
-    ColumnDateTime();
-    explicit ColumnDateTime(std::string timezone);
+    explicit ColumnDateTime(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    explicit ColumnDateTime(std::string timezone, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const std::time_t& value);
@@ -74,6 +79,11 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    size_t FixedRowSize() const override;
+
+    /// Loads rows into memory owned by the application without copying.
+    bool LoadInto(CodedInputStream* input, size_t rows, void* memory) override;
+
 private:
     std::shared_ptr<ColumnUInt32> data_;
 };
@@ -81,8 +91,8 @@ private:
 /** */
 class ColumnDateTime64 : public Column {
 public:
-    explicit ColumnDateTime64(size_t precision);
-    ColumnDateTime64(size_t precision, std::string timezone);
+    explicit ColumnDateTime64(size_t precision, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ColumnDateTime64(size_t precision, std::string timezone, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /// Appends one element to the end of column.
     void Append(const uint64_t& value);
@@ -112,6 +122,11 @@ public:
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    size_t FixedRowSize() const override;
+
+    /// Loads rows into memory owned by the application without copying.
+    bool LoadInto(CodedInputStream* input, size_t rows, void* memory) override;
+
 private:
     std::shared_ptr<ColumnUInt64> data_;
 
@@ -2,15 +2,15 @@
 
 namespace clickhouse {
 
-ColumnDecimal::ColumnDecimal(size_t precision, size_t scale)
+ColumnDecimal::ColumnDecimal(size_t precision, size_t scale, std::pmr::memory_resource* resource)
     : Column(Type::CreateDecimal(precision, scale))
 {
     if (precision <= 9) {
-        data_ = std::make_shared<ColumnInt32>();
+        data_ = std::make_shared<ColumnInt32>(resource);
     } else if (precision <= 18) {
-        data_ = std::make_shared<ColumnInt64>();
+        data_ = std::make_shared<ColumnInt64>(resource);
     } else {
-        data_ = std::make_shared<ColumnInt128>();
+        data_ = std::make_shared<ColumnInt128>(resource);
     }
 }
 
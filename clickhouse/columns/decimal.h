@@ -11,7 +11,7 @@ namespace clickhouse {
  */
 class ColumnDecimal : public Column {
 public:
-    ColumnDecimal(size_t precision, size_t scale);
+    ColumnDecimal(size_t precision, size_t scale, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     void Append(const Int128& value);
     void Append(const std::string& value);
@@ -1,18 +1,28 @@
 #include "enum.h"
-#include "utils.h"
+
+#include <stdexcept>
+#include <string>
 
 namespace clickhouse {
 
 template <typename T>
-ColumnEnum<T>::ColumnEnum(TypeRef type)
+ColumnEnum<T>::ColumnEnum(TypeRef type, std::pmr::memory_resource* resource)
     : Column(type)
+    , data_(resource)
 {
 }
 
 template <typename T>
 ColumnEnum<T>::ColumnEnum(TypeRef type, const std::vector<T>& data)
     : Column(type)
-    , data_(data)
+    , data_(data.begin(), data.end(), std::pmr::get_default_resource())
+{
+}
+
+template <typename T>
+ColumnEnum<T>::ColumnEnum(TypeRef type, SharedVector<T> data)
+    : Column(type)
+    , data_(std::move(data))
 {
 }
 
@@ -21,12 +31,12 @@ void ColumnEnum<T>::Append(const T& value, bool checkValue) {
     if  (checkValue) {
         // TODO type_->HasEnumValue(value), "Enum type doesn't have value " + std::to_string(value);
     }
-    data_.push_back(value);
+    data_.Mutable().push_back(value);
 }
 
 template <typename T>
 void ColumnEnum<T>::Append(const std::string& name) {
-    data_.push_back(EnumType(type_).GetEnumValue(name));
+    data_.Mutable().push_back(EnumType(type_).GetEnumValue(name));
 }
 
 template <typename T>
@@ -36,12 +46,16 @@ void ColumnEnum<T>::Clear() {
 
 template <typename T>
 const T& ColumnEnum<T>::At(size_t n) const {
-    return data_.at(n);
+    if (n >= data_.size()) {
+        throw std::out_of_range("row index is out of range. Index: [" + std::to_string(n) + "], rows: [" + std::to_string(data_.size()) + "]");
+    }
+
+    return data_[n];
 }
 
 template <typename T>
 const std::string ColumnEnum<T>::NameAt(size_t n) const {
-    return EnumType(type_).GetEnumName(data_.at(n));
+    return EnumType(type_).GetEnumName(At(n));
 }
 
 template <typename T>
@@ -54,25 +68,29 @@ void ColumnEnum<T>::SetAt(size_t n, const T& value, bool checkValue) {
     if (checkValue) {
         // TODO: type_->HasEnumValue(value), "Enum type doesn't have value " + std::to_string(value);
     }
-    data_.at(n) = value;
+    data_.Mutable().at(n) = value;
 }
 
 template <typename T>
 void ColumnEnum<T>::SetNameAt(size_t n, const std::string& name) {
-    data_.at(n) = EnumType(type_).GetEnumValue(name);
+    data_.Mutable().at(n) = EnumType(type_).GetEnumValue(name);
 }
 
 template <typename T>
 void ColumnEnum<T>::Append(ColumnRef column) {
     if (auto col = column->As<ColumnEnum<T>>()) {
-        data_.insert(data_.end(), col->data_.begin(), col->data_.end());
+        auto& data = data_.Mutable();
+        data.insert(data.end(), col->data_.data(), col->data_.data() + col->data_.size());
     }
 }
 
 template <typename T>
 bool ColumnEnum<T>::Load(CodedInputStream* input, size_t rows) {
-    data_.resize(rows);
-    return input->ReadRaw(data_.data(), data_.size() * sizeof(T));
+    data_.clear();
+
+    auto& data = data_.Mutable();
+    data.resize(rows);
+    return input->ReadRaw(data.data(), data.size() * sizeof(T));
 }
 
 template <typename T>
@@ -87,7 +105,7 @@ size_t ColumnEnum<T>::Size() const {
 
 template <typename T>
 ColumnRef ColumnEnum<T>::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnEnum<T>>(type_, SliceVector(data_, begin, len));
+    return std::shared_ptr<ColumnEnum<T>>(new ColumnEnum<T>(type_, data_.Slice(begin, len)));
 }
 
 template class ColumnEnum<int8_t>;
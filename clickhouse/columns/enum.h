@@ -1,6 +1,7 @@
 #pragma once
 
 #include "column.h"
+#include "utils.h"
 
 namespace clickhouse {
 
@@ -8,7 +9,7 @@ namespace clickhouse {
 template <typename T>
 class ColumnEnum : public Column {
 public:
-    ColumnEnum(TypeRef type);
+    explicit ColumnEnum(TypeRef type, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ColumnEnum(TypeRef type, const std::vector<T>& data);
 
     /// Appends one element to the end of column.
@@ -42,11 +43,14 @@ public:
     /// Returns count of rows in the column.
     size_t Size() const override;
 
-    /// Makes slice of the current column.
+    /// Makes slice of the current column, which shares rows with it.
     ColumnRef Slice(size_t begin, size_t len) override;
 
 private:
-    std::vector<T> data_;
+    ColumnEnum(TypeRef type, SharedVector<T> data); // for `Slice(…)`
+
+private:
+    SharedVector<T> data_;
 };
 
 using ColumnEnum8 = ColumnEnum<int8_t>;
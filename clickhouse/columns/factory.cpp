@@ -18,96 +18,97 @@
 namespace clickhouse {
 namespace {
 
-static ColumnRef CreateTerminalColumn(const TypeAst& ast) {
+static ColumnRef CreateTerminalColumn(const TypeAst& ast, std::pmr::memory_resource* resource) {
     switch (ast.code) {
     case Type::Void:
         return std::make_shared<ColumnNothing>();
 
     case Type::UInt8:
-        return std::make_shared<ColumnUInt8>();
+        return std::make_shared<ColumnUInt8>(resource);
     case Type::UInt16:
-        return std::make_shared<ColumnUInt16>();
+        return std::make_shared<ColumnUInt16>(resource);
     case Type::UInt32:
-        return std::make_shared<ColumnUInt32>();
+        return std::make_shared<ColumnUInt32>(resource);
     case Type::UInt64:
-        return std::make_shared<ColumnUInt64>();
+        return std::make_shared<ColumnUInt64>(resource);
 
     case Type::Int8:
-        return std::make_shared<ColumnInt8>();
+        return std::make_shared<ColumnInt8>(resource);
     case Type::Int16:
-        return std::make_shared<ColumnInt16>();
+        return std::make_shared<ColumnInt16>(resource);
     case Type::Int32:
-        return std::make_shared<ColumnInt32>();
+        return std::make_shared<ColumnInt32>(resource);
     case Type::Int64:
-        return std::make_shared<ColumnInt64>();
+        return std::make_shared<ColumnInt64>(resource);
 
     case Type::Float32:
-        return std::make_shared<ColumnFloat32>();
+        return std::make_shared<ColumnFloat32>(resource);
     case Type::Float64:
-        return std::make_shared<ColumnFloat64>();
+        return std::make_shared<ColumnFloat64>(resource);
 
     case Type::Decimal:
-        return std::make_shared<ColumnDecimal>(ast.elements.front().value, ast.elements.back().value);
+        return std::make_shared<ColumnDecimal>(ast.elements.front().value, ast.elements.back().value, resource);
     case Type::Decimal32:
-        return std::make_shared<ColumnDecimal>(9, ast.elements.front().value);
+        return std::make_shared<ColumnDecimal>(9, ast.elements.front().value, resource);
     case Type::Decimal64:
-        return std::make_shared<ColumnDecimal>(18, ast.elements.front().value);
+        return std::make_shared<ColumnDecimal>(18, ast.elements.front().value, resource);
     case Type::Decimal128:
-        return std::make_shared<ColumnDecimal>(38, ast.elements.front().value);
+        return std::make_shared<ColumnDecimal>(38, ast.elements.front().value, resource);
 
     case Type::String:
-        return std::make_shared<ColumnString>();
+        return std::make_shared<ColumnString>(resource);
     case Type::FixedString:
-        return std::make_shared<ColumnFixedString>(ast.elements.front().value);
+        return std::make_shared<ColumnFixedString>(ast.elements.front().value, resource);
 
     case Type::DateTime:
         if (ast.elements.empty()) {
-            return std::make_shared<ColumnDateTime>();
+            return std::make_shared<ColumnDateTime>(resource);
         } else {
-            return std::make_shared<ColumnDateTime>(ast.elements[0].value_string);
+            return std::make_shared<ColumnDateTime>(ast.elements[0].value_string, resource);
         }
     case Type::DateTime64:
         if (ast.elements.empty()) {
             return nullptr;
         }
         if (ast.elements.size() == 1) {
-            return std::make_shared<ColumnDateTime64>(ast.elements[0].value);
+            return std::make_shared<ColumnDateTime64>(ast.elements[0].value, resource);
         } else {
-            return std::make_shared<ColumnDateTime64>(ast.elements[0].value, ast.elements[1].value_string);
+            return std::make_shared<ColumnDateTime64>(ast.elements[0].value, ast.elements[1].value_string, resource);
         }
     case Type::Date:
-        return std::make_shared<ColumnDate>();
+        return std::make_shared<ColumnDate>(resource);
 
     case Type::IPv4:
-        return std::make_shared<ColumnIPv4>();
+        return std::make_shared<ColumnIPv4>(resource);
     case Type::IPv6:
-        return std::make_shared<ColumnIPv6>();
+        return std::make_shared<ColumnIPv6>(resource);
 
     case Type::UUID:
-        return std::make_shared<ColumnUUID>();
+        return std::make_shared<ColumnUUID>(resource);
 
     default:
         return nullptr;
     }
 }
 
-static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
+static ColumnRef CreateColumnFromAst(const TypeAst& ast, std::pmr::memory_resource* resource) {
     switch (ast.meta) {
         case TypeAst::Array: {
             return std::make_shared<ColumnArray>(
-                CreateColumnFromAst(ast.elements.front())
+                CreateColumnFromAst(ast.elements.front(), resource),
+                resource
             );
         }
 
         case TypeAst::Nullable: {
             return std::make_shared<ColumnNullable>(
-                CreateColumnFromAst(ast.elements.front()),
-                std::make_shared<ColumnUInt8>()
+                CreateColumnFromAst(ast.elements.front(), resource),
+                std::make_shared<ColumnUInt8>(resource)
             );
         }
 
         case TypeAst::Terminal: {
-            return CreateTerminalColumn(ast);
+            return CreateTerminalColumn(ast, resource);
         }
 
         case TypeAst::Tuple: {
@@ -115,7 +116,7 @@ static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
 
             columns.reserve(ast.elements.size());
             for (const auto& elem : ast.elements) {
-                if (auto col = CreateColumnFromAst(elem)) {
+                if (auto col = CreateColumnFromAst(elem, resource)) {
                     columns.push_back(col);
                 } else {
                     return nullptr;
@@ -137,11 +138,11 @@ static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
 
             if (ast.code == Type::Enum8) {
                 return std::make_shared<ColumnEnum8>(
-                    Type::CreateEnum8(enum_items)
+                    Type::CreateEnum8(enum_items), resource
                 );
             } else if (ast.code == Type::Enum16) {
                 return std::make_shared<ColumnEnum16>(
-                    Type::CreateEnum16(enum_items)
+                    Type::CreateEnum16(enum_items), resource
                 );
             }
             break;
@@ -160,10 +161,11 @@ static ColumnRef CreateColumnFromAst(const TypeAst& ast) {
 } // namespace
 
 
-ColumnRef CreateColumnByType(const std::string& type_name) {
+ColumnRef CreateColumnByType(const std::string& type_name,
+                             std::pmr::memory_resource* resource) {
     auto ast = ParseTypeName(type_name);
     if (ast != nullptr) {
-        return CreateColumnFromAst(*ast);
+        return CreateColumnFromAst(*ast, resource);
     }
 
     return nullptr;
@@ -4,6 +4,9 @@
 
 namespace clickhouse {
 
-ColumnRef CreateColumnByType(const std::string& type_name);
+/// Creates an empty column of the given type.  Rows of the column and of
+/// its nested columns are allocated from \p resource.
+ColumnRef CreateColumnByType(const std::string& type_name,
+                             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 }
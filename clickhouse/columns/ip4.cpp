@@ -9,9 +9,9 @@ using in_addr_t = unsigned long;
 
 namespace clickhouse {
 
-ColumnIPv4::ColumnIPv4()
+ColumnIPv4::ColumnIPv4(std::pmr::memory_resource* resource)
     : Column(Type::CreateIPv4())
-    , data_(std::make_shared<ColumnUInt32>())
+    , data_(std::make_shared<ColumnUInt32>(resource))
 {
 }
 
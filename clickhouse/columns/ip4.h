@@ -7,7 +7,7 @@ namespace clickhouse {
 
 class ColumnIPv4 : public Column {
 public:
-    ColumnIPv4();
+    explicit ColumnIPv4(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     explicit ColumnIPv4(ColumnRef data);
 
     /// Appends one element to the column.
@@ -7,9 +7,9 @@ namespace clickhouse {
 
 static_assert(sizeof(struct in6_addr) == 16, "sizeof in6_addr should be 16 bytes");
 
-ColumnIPv6::ColumnIPv6()
+ColumnIPv6::ColumnIPv6(std::pmr::memory_resource* resource)
     : Column(Type::CreateIPv6())
-    , data_(std::make_shared<ColumnFixedString>(16))
+    , data_(std::make_shared<ColumnFixedString>(16, resource))
 {
 }
 
@@ -27,11 +27,11 @@ void ColumnIPv6::Append(const std::string& ip) {
     if (inet_pton(AF_INET6, ip.c_str(), buf) != 1) {
         throw std::runtime_error("invalid IPv6 format, ip: " + ip);
     }
-    data_->Append(std::string((const char*)buf, 16));
+    data_->Append(std::string_view((const char*)buf, 16));
 }
 
 void ColumnIPv6::Append(const in6_addr* addr) {
-    data_->Append(std::string((const char*)addr->s6_addr, 16));
+    data_->Append(std::string_view((const char*)addr->s6_addr, 16));
 }
 
 void ColumnIPv6::Clear() {
@@ -39,11 +39,11 @@ void ColumnIPv6::Clear() {
 }
 
 std::string ColumnIPv6::AsString (size_t n) const{
-    const auto& addr = data_->At(n);
+    const auto addr = data_->At(n);
     char buf[INET6_ADDRSTRLEN];
     const char* ip_str = inet_ntop(AF_INET6, addr.data(), buf, INET6_ADDRSTRLEN);
     if (ip_str == nullptr) {
-        throw std::runtime_error("invalid IPv6 format: " + addr);
+        throw std::runtime_error("invalid IPv6 format: " + std::string(addr));
     }
     return ip_str;
 }
@@ -53,7 +53,7 @@ in6_addr ColumnIPv6::At(size_t n) const {
 }
 
 in6_addr ColumnIPv6::operator [] (size_t n) const {
-    return *reinterpret_cast<const in6_addr*>(data_->At(n).data());
+    return *reinterpret_cast<const in6_addr*>((*data_)[n].data());
 }
 
 void ColumnIPv6::Append(ColumnRef column) {
@@ -7,7 +7,7 @@ namespace clickhouse {
 
 class ColumnIPv6 : public Column{
 public:
-    ColumnIPv6();
+    explicit ColumnIPv6(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     explicit ColumnIPv6(ColumnRef data);
 
     /// Appends one element to the column.
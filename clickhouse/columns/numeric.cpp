@@ -1,68 +1,129 @@
 #include "numeric.h"
-#include "utils.h"
+#include <stdexcept>
+#include <string>
 
 namespace clickhouse {
 
 template <typename T>
-ColumnVector<T>::ColumnVector()
+ColumnVector<T>::ColumnVector(std::pmr::memory_resource* resource)
     : Column(Type::CreateSimple<T>())
+    , data_(resource)
 {
 }
 
 template <typename T>
 ColumnVector<T>::ColumnVector(const std::vector<T>& data)
     : Column(Type::CreateSimple<T>())
-    , data_(data)
+    , data_(data.begin(), data.end(), std::pmr::get_default_resource())
+{
+}
+
+template <typename T>
+ColumnVector<T>::ColumnVector(SharedVector<T> data)
+    : Column(Type::CreateSimple<T>())
+    , data_(std::move(data))
 {
 }
 
 template <typename T>
 void ColumnVector<T>::Append(const T& value) {
-    data_.push_back(value);
+    Mutable().push_back(value);
 }
 
 template <typename T>
 void ColumnVector<T>::Clear() {
+    external_ = nullptr;
+    external_rows_ = 0;
     data_.clear();
 }
 
 template <typename T>
 const T& ColumnVector<T>::At(size_t n) const {
-    return data_.at(n);
+    if (n >= Size()) {
+        throw std::out_of_range("row index is out of range. Index: [" + std::to_string(n) + "], rows: [" + std::to_string(Size()) + "]");
+    }
+
+    return Data()[n];
 }
 
 template <typename T>
 const T& ColumnVector<T>::operator [] (size_t n) const {
-    return data_[n];
+    return Data()[n];
 }
 
 template <typename T>
 void ColumnVector<T>::Append(ColumnRef column) {
     if (auto col = column->As<ColumnVector<T>>()) {
-        data_.insert(data_.end(), col->data_.begin(), col->data_.end());
+        auto& data = Mutable();
+        data.insert(data.end(), col->Data(), col->Data() + col->Size());
     }
 }
 
 template <typename T>
 bool ColumnVector<T>::Load(CodedInputStream* input, size_t rows) {
-    data_.resize(rows);
+    external_ = nullptr;
+    external_rows_ = 0;
+    data_.clear();
+
+    auto& data = data_.Mutable();
+    data.resize(rows);
+
+    return input->ReadRaw(data.data(), data.size() * sizeof(T));
+}
+
+template <typename T>
+bool ColumnVector<T>::LoadInto(CodedInputStream* input, size_t rows, void* memory) {
+    data_.clear();
+    external_ = static_cast<T*>(memory);
+    external_rows_ = rows;
 
-    return input->ReadRaw(data_.data(), data_.size() * sizeof(T));
+    return input->ReadRaw(external_, rows * sizeof(T));
 }
 
 template <typename T>
 void ColumnVector<T>::Save(CodedOutputStream* output) {
-    output->WriteRaw(data_.data(), data_.size() * sizeof(T));
+    output->WriteRaw(Data(), Size() * sizeof(T));
 }
 
 template <typename T>
 size_t ColumnVector<T>::Size() const {
-    return data_.size();
+    return external_ ? external_rows_ : data_.size();
+}
+
+template <typename T>
+size_t ColumnVector<T>::FixedRowSize() const {
+    return sizeof(T);
 }
 
 template <typename T>
 ColumnRef ColumnVector<T>::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnVector<T>>(SliceVector(data_, begin, len));
+    if (external_) {
+        // Memory of the application outlives the column and its slices.
+        auto result = std::make_shared<ColumnVector<T>>(data_.resource());
+
+        begin = std::min(begin, external_rows_);
+        result->external_ = external_ + begin;
+        result->external_rows_ = std::min(len, external_rows_ - begin);
+
+        return result;
+    }
+
+    return std::shared_ptr<ColumnVector<T>>(new ColumnVector<T>(data_.Slice(begin, len)));
+}
+
+template <typename T>
+typename SharedVector<T>::Vector& ColumnVector<T>::Mutable() {
+    if (external_) {
+        auto& data = data_.Mutable();
+
+        data.assign(external_, external_ + external_rows_);
+        external_ = nullptr;
+        external_rows_ = 0;
+
+        return data;
+    }
+
+    return data_.Mutable();
 }
 
 template class ColumnVector<int8_t>;
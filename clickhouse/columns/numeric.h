@@ -1,6 +1,7 @@
 #pragma once
 
 #include "column.h"
+#include "utils.h"
 #include "absl/numeric/int128.h"
 
 namespace clickhouse {
@@ -13,7 +14,8 @@ class ColumnVector : public Column {
 public:
     using DataType = T;
 
-    ColumnVector();
+    /// Creates an empty column which allocates rows from \p resource.
+    explicit ColumnVector(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     explicit ColumnVector(const std::vector<T>& data);
 
@@ -42,11 +44,31 @@ public:
     /// Returns count of rows in the column.
     size_t Size() const override;
 
-    /// Makes slice of the current column.
+    /// Makes slice of the current column, which shares rows with it.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+    size_t FixedRowSize() const override;
+
+    /// Loads rows into memory owned by the application without copying.
+    bool LoadInto(CodedInputStream* input, size_t rows, void* memory) override;
+
+private:
+    explicit ColumnVector(SharedVector<T> data); // for `Slice(…)`
+
+    /// Returns pointer to the first row.
+    inline const T* Data() const {
+        return external_ ? external_ : data_.data();
+    }
+
+    /// Returns rows for modification.  Rows shared with other columns or
+    /// kept in memory of the application are copied into data_ first.
+    typename SharedVector<T>::Vector& Mutable();
+
 private:
-    std::vector<T> data_;
+    SharedVector<T> data_;
+    /// Rows loaded by LoadInto().
+    T* external_ = nullptr;
+    size_t external_rows_ = 0;
 };
 
 using Int128 = absl::int128;
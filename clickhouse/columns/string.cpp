@@ -3,134 +3,302 @@
 
 #include "../base/wire_format.h"
 
+#include <stdexcept>
+#include <string>
+
 namespace clickhouse {
 
-ColumnFixedString::ColumnFixedString(size_t n)
+ColumnFixedString::ColumnFixedString(size_t n, std::pmr::memory_resource* resource)
+    : Column(Type::CreateString(n))
+    , string_size_(n)
+    , data_(resource)
+{
+}
+
+ColumnFixedString::ColumnFixedString(size_t n, SharedVector<char> data)
     : Column(Type::CreateString(n))
     , string_size_(n)
+    , data_(std::move(data))
 {
 }
 
-void ColumnFixedString::Append(const std::string& str) {
-    data_.push_back(str);
-    data_.back().resize(string_size_);
+void ColumnFixedString::Append(std::string_view str) {
+    const size_t len = std::min(str.size(), string_size_);
+    auto& data = data_.Mutable();
+
+    data.insert(data.end(), str.begin(), str.begin() + len);
+    data.resize(data.size() + (string_size_ - len), '\0');
 }
 
 void ColumnFixedString::Clear() {
     data_.clear();
 }
 
-const std::string& ColumnFixedString::At(size_t n) const {
-    return data_.at(n);
+std::string_view ColumnFixedString::At(size_t n) const {
+    if (n >= Size()) {
+        throw std::out_of_range("row index is out of range. Index: [" + std::to_string(n) + "], rows: [" + std::to_string(Size()) + "]");
+    }
+
+    return std::string_view(data_.data() + n * string_size_, string_size_);
 }
 
-const std::string& ColumnFixedString::operator [] (size_t n) const {
-    return data_[n];
+std::string_view ColumnFixedString::operator [] (size_t n) const {
+    return std::string_view(data_.data() + n * string_size_, string_size_);
 }
 
 void ColumnFixedString::Append(ColumnRef column) {
     if (auto col = column->As<ColumnFixedString>()) {
         if (string_size_ == col->string_size_) {
-            data_.insert(data_.end(), col->data_.begin(), col->data_.end());
+            auto& data = data_.Mutable();
+            data.insert(data.end(), col->data_.data(), col->data_.data() + col->data_.size());
         }
     }
 }
 
 bool ColumnFixedString::Load(CodedInputStream* input, size_t rows) {
-    for (size_t i = 0; i < rows; ++i) {
-        std::string s;
-        s.resize(string_size_);
-
-        if (!WireFormat::ReadBytes(input, &s[0], s.size())) {
-            return false;
-        }
+    auto& data = data_.Mutable();
+    const size_t pos = data.size();
 
-        data_.push_back(std::move(s));
-    }
+    data.resize(pos + rows * string_size_);
 
-    return true;
+    return WireFormat::ReadBytes(input, data.data() + pos, rows * string_size_);
 }
 
 void ColumnFixedString::Save(CodedOutputStream* output) {
-    for (size_t i = 0; i < data_.size(); ++i) {
-        WireFormat::WriteBytes(output, data_[i].data(), string_size_);
-    }
+    WireFormat::WriteBytes(output, data_.data(), data_.size());
 }
 
 size_t ColumnFixedString::Size() const {
-    return data_.size();
+    return string_size_ ? data_.size() / string_size_ : 0;
 }
 
 ColumnRef ColumnFixedString::Slice(size_t begin, size_t len) {
-    auto result = std::make_shared<ColumnFixedString>(string_size_);
-
-    if (begin < data_.size()) {
-        result->data_ = SliceVector(data_, begin, len);
+    if (begin >= Size()) {
+        begin = len = 0;
     }
+    len = std::min(len, Size() - begin);
 
-    return result;
+    return std::shared_ptr<ColumnFixedString>(new ColumnFixedString(
+        string_size_, data_.Slice(begin * string_size_, len * string_size_)));
 }
 
 
-ColumnString::ColumnString()
+ColumnString::ColumnString(std::pmr::memory_resource* resource)
     : Column(Type::CreateString())
+    , offsets_(resource)
+    , chars_(resource)
 {
 }
 
 ColumnString::ColumnString(const std::vector<std::string>& data)
     : Column(Type::CreateString())
-    , data_(data)
+    , offsets_(std::pmr::get_default_resource())
+    , chars_(std::pmr::get_default_resource())
 {
+    size_t total = 0;
+    for (const auto& s : data) {
+        total += s.size();
+    }
+
+    offsets_.Mutable().reserve(data.size());
+    chars_.Mutable().reserve(total);
+
+    for (const auto& s : data) {
+        Append(s);
+    }
 }
 
-void ColumnString::Append(const std::string& str) {
-    data_.push_back(str);
+ColumnString::ColumnString(SharedVector<size_t> offsets, SharedVector<char> chars, size_t first)
+    : Column(Type::CreateString())
+    , offsets_(std::move(offsets))
+    , chars_(std::move(chars))
+    , first_(first)
+{
+}
+
+void ColumnString::Append(std::string_view str) {
+    Detach();
+
+    auto& chars = chars_.Mutable();
+    chars.insert(chars.end(), str.begin(), str.end());
+    offsets_.Mutable().push_back(chars.size());
 }
 
 void ColumnString::Clear() {
-    data_.clear();
+    offsets_.clear();
+    chars_.clear();
+    first_ = 0;
 }
 
-const std::string& ColumnString::At(size_t n) const {
-    return data_.at(n);
+std::string_view ColumnString::At(size_t n) const {
+    if (n >= offsets_.size()) {
+        throw std::out_of_range("row index is out of range. Index: [" + std::to_string(n) + "], rows: [" + std::to_string(offsets_.size()) + "]");
+    }
+
+    const size_t end = offsets_[n];
+    const size_t begin = RowBegin(n);
+
+    return std::string_view(chars_.data() + begin, end - begin);
 }
 
-const std::string& ColumnString::operator [] (size_t n) const {
-    return data_[n];
+std::string_view ColumnString::operator [] (size_t n) const {
+    const size_t begin = RowBegin(n);
+
+    return std::string_view(chars_.data() + begin, offsets_[n] - begin);
 }
 
 void ColumnString::Append(ColumnRef column) {
     if (auto col = column->As<ColumnString>()) {
-        data_.insert(data_.end(), col->data_.begin(), col->data_.end());
+        const size_t count = col->offsets_.size();
+        const size_t first = col->first_;
+        const size_t last = count ? col->offsets_[count - 1] : first;
+
+        Detach();
+
+        auto& chars = chars_.Mutable();
+        auto& offsets = offsets_.Mutable();
+        const size_t base = chars.size();
+
+        chars.insert(chars.end(), col->chars_.data() + first, col->chars_.data() + last);
+
+        offsets.reserve(offsets.size() + count);
+        for (size_t i = 0; i < count; ++i) {
+            offsets.push_back(base + col->offsets_[i] - first);
+        }
     }
 }
 
 bool ColumnString::Load(CodedInputStream* input, size_t rows) {
-    for (size_t i = 0; i < rows; ++i) {
-        std::string s;
+    Detach();
+
+    auto& offsets = offsets_.Mutable();
+    auto& chars = chars_.Mutable();
+    const size_t offsets_size = offsets.size();
+    const size_t chars_size = chars.size();
+
+    // Drops rows of a partially loaded block, so offsets do not point
+    // past the chars.
+    auto fail = [&] () {
+        offsets.resize(offsets_size);
+        chars.resize(chars_size);
+        return false;
+    };
+
+    offsets.reserve(offsets.size() + rows);
+
+    for (size_t i = 0; i < rows; ) {
+        const void* ptr;
+        const size_t avail = input->Peek(&ptr);
+        const uint8_t* const window = static_cast<const uint8_t*>(ptr);
+        size_t pos = 0;
+
+        // Parse rows which lie entirely within the data at hand.
+        for (; i < rows; ++i) {
+            uint64_t len;
+            const size_t size = CodedInputStream::DecodeVarint(window + pos, avail - pos, &len);
+
+            if (!size) {
+                break;
+            }
+            if (len > 0x00FFFFFFULL) {
+                return fail();
+            }
+            if (len > avail - pos - size) {
+                break;
+            }
+
+            chars.insert(chars.end(), window + pos + size, window + pos + size + len);
+            offsets.push_back(chars.size());
+
+            pos += size + len;
+        }
 
-        if (!WireFormat::ReadString(input, &s)) {
-            return false;
+        if (pos && !input->Skip(pos)) {
+            return fail();
         }
 
-        data_.push_back(std::move(s));
+        // The row straddles a refill of the buffer.
+        if (i < rows) {
+            if (!LoadRow(input)) {
+                return fail();
+            }
+            ++i;
+        }
     }
 
     return true;
 }
 
+bool ColumnString::LoadRow(CodedInputStream* input) {
+    uint64_t len;
+
+    if (!input->ReadVarint64(&len) || len > 0x00FFFFFFULL) {
+        return false;
+    }
+
+    auto& chars = chars_.Mutable();
+    const size_t pos = chars.size();
+    chars.resize(pos + len);
+
+    if (!input->ReadRaw(chars.data() + pos, len)) {
+        return false;
+    }
+
+    offsets_.Mutable().push_back(chars.size());
+
+    return true;
+}
+
 void ColumnString::Save(CodedOutputStream* output) {
-    for (auto si = data_.begin(); si != data_.end(); ++si) {
-        WireFormat::WriteString(output, *si);
+    size_t begin = first_;
+
+    for (size_t i = 0; i < offsets_.size(); ++i) {
+        const size_t end = offsets_[i];
+
+        output->WriteVarint64(end - begin);
+        output->WriteRaw(chars_.data() + begin, end - begin);
+        begin = end;
     }
 }
 
 size_t ColumnString::Size() const {
-    return data_.size();
+    return offsets_.size();
 }
 
 ColumnRef ColumnString::Slice(size_t begin, size_t len) {
-    return std::make_shared<ColumnString>(SliceVector(data_, begin, len));
+    if (begin >= offsets_.size()) {
+        begin = len = 0;
+    }
+    len = std::min(len, offsets_.size() - begin);
+
+    const size_t first = len ? RowBegin(begin) : 0;
+    const size_t last = len ? offsets_[begin + len - 1] : 0;
+
+    // Offsets of the slice keep pointing into the same chars.
+    return std::shared_ptr<ColumnString>(new ColumnString(
+        offsets_.Slice(begin, len), chars_.Slice(0, last), first));
+}
+
+void ColumnString::Detach() {
+    if (first_ == 0) {
+        return;
+    }
+
+    const size_t count = offsets_.size();
+    const size_t last = count ? offsets_[count - 1] : first_;
+
+    SharedVector<char> chars(chars_.data() + first_, chars_.data() + last, chars_.resource());
+    SharedVector<size_t> offsets(offsets_.resource());
+
+    auto& rebased = offsets.Mutable();
+    rebased.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        rebased.push_back(offsets_[i] - first_);
+    }
+
+    chars_ = std::move(chars);
+    offsets_ = std::move(offsets);
+    first_ = 0;
 }
 
 }
@@ -1,24 +1,31 @@
 #pragma once
 
 #include "column.h"
+#include "utils.h"
+
+#include <string_view>
 
 namespace clickhouse {
 
 /**
  * Represents column of fixed-length strings.
+ *
+ * All values have exactly string_size_ bytes, so rows are kept back to back
+ * in a single buffer.
  */
 class ColumnFixedString : public Column {
 public:
-    explicit ColumnFixedString(size_t n);
+    explicit ColumnFixedString(size_t n, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-    /// Appends one element to the column.
-    void Append(const std::string& str);
+    /// Appends one element to the column.  The value is truncated or padded
+    /// with zero bytes up to the size of the column's type.
+    void Append(std::string_view str);
 
     /// Returns element at given row number.
-    const std::string& At(size_t n) const;
+    std::string_view At(size_t n) const;
 
     /// Returns element at given row number.
-    const std::string& operator [] (size_t n) const;
+    std::string_view operator [] (size_t n) const;
 
 public:
     /// Appends content of given column to the end of current one.
@@ -36,30 +43,37 @@ public:
     /// Returns count of rows in the column.
     size_t Size() const override;
 
-    /// Makes slice of the current column.
+    /// Makes slice of the current column, which shares rows with it.
     ColumnRef Slice(size_t begin, size_t len) override;
 
+private:
+    ColumnFixedString(size_t n, SharedVector<char> data); // for `Slice(…)`
+
 private:
     const size_t string_size_;
-    std::vector<std::string> data_;
+    SharedVector<char> data_;
 };
 
 /**
  * Represents column of variable-length strings.
+ *
+ * Rows are stored the way ClickHouse does it: bytes of all strings are
+ * placed one after another in a single buffer and a separate array keeps
+ * the end offset of every row.
  */
 class ColumnString : public Column {
 public:
-    ColumnString();
+    explicit ColumnString(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     explicit ColumnString(const std::vector<std::string>& data);
 
     /// Appends one element to the column.
-    void Append(const std::string& str);
+    void Append(std::string_view str);
 
     /// Returns element at given row number.
-    const std::string& At(size_t n) const;
+    std::string_view At(size_t n) const;
 
     /// Returns element at given row number.
-    const std::string& operator [] (size_t n) const;
+    std::string_view operator [] (size_t n) const;
 
 public:
     /// Appends content of given column to the end of current one.
@@ -77,11 +91,32 @@ public:
     /// Returns count of rows in the column.
     size_t Size() const override;
 
-    /// Makes slice of the current column.
+    /// Makes slice of the current column, which shares rows with it.
     ColumnRef Slice(size_t begin, size_t len) override;
 
 private:
-    std::vector<std::string> data_;
+    ColumnString(SharedVector<size_t> offsets, SharedVector<char> chars, size_t first); // for `Slice(…)`
+
+    /// Position of the first byte of the n-th row.
+    inline size_t RowBegin(size_t n) const {
+        return n == 0 ? first_ : offsets_[n - 1];
+    }
+
+    /// Reads a single row byte by byte.
+    bool LoadRow(CodedInputStream* input);
+
+    /// Rebases rows of a slice to the beginning of their own chars,
+    /// so new rows can be appended.
+    void Detach();
+
+private:
+    /// End offset of each row in chars_.
+    SharedVector<size_t> offsets_;
+    /// Bytes of all rows stored contiguously.  May be shared with
+    /// the column the current one was sliced from.
+    SharedVector<char> chars_;
+    /// Position of the first byte of the first row in chars_.
+    size_t first_ = 0;
 };
 
 }
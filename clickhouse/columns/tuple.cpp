@@ -41,7 +41,20 @@ void ColumnTuple::Save(CodedOutputStream* output) {
 }
 
 void ColumnTuple::Clear() {
-    columns_.clear();
+    for (auto& col : columns_) {
+        col->Clear();
+    }
+}
+
+ColumnRef ColumnTuple::Slice(size_t begin, size_t len) {
+    std::vector<ColumnRef> columns;
+
+    columns.reserve(columns_.size());
+    for (const auto& col : columns_) {
+        columns.push_back(col->Slice(begin, len));
+    }
+
+    return std::make_shared<ColumnTuple>(columns);
 }
 
 }
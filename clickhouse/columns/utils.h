@@ -1,20 +1,144 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
 #include <vector>
 
 namespace clickhouse {
 
+/**
+ * A range of elements of a vector, which can be shared by a column and
+ * its slices without copying.  The range is copied into a vector of its
+ * own before the first modification, if the vector has ever been shared
+ * or the range does not cover all of it.
+ *
+ * Sharing is recorded in the vector once and for all, rather than judged by
+ * the count of live references: a reference may be released by another
+ * thread without any ordering with the modification.
+ */
 template <typename T>
-std::vector<T> SliceVector(const std::vector<T>& vec, size_t begin, size_t len) {
-    std::vector<T> result;
+class SharedVector {
+public:
+    using Vector = std::pmr::vector<T>;
 
-    if (begin < vec.size()) {
-        len = std::min(len, vec.size() - begin);
-        result.assign(vec.begin() + begin, vec.begin() + (begin + len));
+    explicit SharedVector(std::pmr::memory_resource* resource)
+        : data_(Allocate(resource))
+    {
     }
 
-    return result;
-}
+    template <typename Iterator>
+    SharedVector(Iterator begin, Iterator end, std::pmr::memory_resource* resource)
+        : SharedVector(resource)
+    {
+        data_->vector.assign(begin, end);
+    }
+
+    SharedVector(const SharedVector& other) noexcept
+        : data_(other.data_)
+        , offset_(other.offset_)
+        , size_(other.size_)
+        , whole_(other.whole_)
+    {
+        data_->shared = true;
+    }
+
+    SharedVector(SharedVector&&) noexcept = default;
+
+    SharedVector& operator = (const SharedVector& other) noexcept {
+        if (this != &other) {
+            other.data_->shared = true;
+            data_ = other.data_;
+            offset_ = other.offset_;
+            size_ = other.size_;
+            whole_ = other.whole_;
+        }
+        return *this;
+    }
+
+    SharedVector& operator = (SharedVector&&) noexcept = default;
+
+    inline const T* data() const noexcept {
+        return data_->vector.data() + offset_;
+    }
+
+    inline size_t size() const noexcept {
+        return whole_ ? data_->vector.size() : size_;
+    }
+
+    inline const T& operator [] (size_t n) const noexcept {
+        return data()[n];
+    }
+
+    inline std::pmr::memory_resource* resource() const noexcept {
+        return data_->vector.get_allocator().resource();
+    }
+
+    /// Returns a range of \p len elements starting at \p begin, which
+    /// shares memory with the current one.
+    SharedVector Slice(size_t begin, size_t len) const {
+        SharedVector result(*this);
+
+        begin = std::min(begin, size());
+        result.offset_ = offset_ + begin;
+        result.size_ = std::min(len, size() - begin);
+        result.whole_ = false;
+
+        return result;
+    }
+
+    /// Returns the vector of elements for modification.
+    Vector& Mutable() {
+        if (!whole_ || data_->shared) {
+            auto data = Allocate(resource());
+
+            data->vector.assign(this->data(), this->data() + size());
+            data_ = std::move(data);
+            offset_ = 0;
+            whole_ = true;
+        }
+
+        return data_->vector;
+    }
+
+    /// Removes all elements.  Capacity is kept if the vector has not been
+    /// shared.
+    void clear() {
+        if (!whole_ || data_->shared) {
+            data_ = Allocate(resource());
+            offset_ = 0;
+            whole_ = true;
+        } else {
+            data_->vector.clear();
+        }
+    }
+
+private:
+    struct Storage {
+        explicit Storage(std::pmr::memory_resource* resource)
+            : vector(resource)
+        {
+        }
+
+        Vector vector;
+        /// The vector has been shared with another range, which may still
+        /// be reading it, so it is never modified in place again.
+        std::atomic<bool> shared{false};
+    };
+
+    static std::shared_ptr<Storage> Allocate(std::pmr::memory_resource* resource) {
+        return std::allocate_shared<Storage>(
+            std::pmr::polymorphic_allocator<Storage>(resource), resource);
+    }
+
+private:
+    std::shared_ptr<Storage> data_;
+    /// Position of the first element of the range.
+    size_t offset_ = 0;
+    /// Count of elements in the range, if it does not cover all of data_.
+    size_t size_ = 0;
+    bool whole_ = true;
+};
 
 }
@@ -5,9 +5,9 @@
 
 namespace clickhouse {
 
-ColumnUUID::ColumnUUID()
+ColumnUUID::ColumnUUID(std::pmr::memory_resource* resource)
     : Column(Type::CreateUUID())
-    , data_(std::make_shared<ColumnUInt64>())
+    , data_(std::make_shared<ColumnUInt64>(resource))
 {
 }
 
@@ -12,7 +12,7 @@ using UInt128 = std::pair<uint64_t, uint64_t>;
  */
 class ColumnUUID : public Column {
 public:
-    ColumnUUID();
+    explicit ColumnUUID(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     explicit ColumnUUID(ColumnRef data);
 
@@ -1,7 +1,123 @@
 #include "query.h"
 
+#include <stdexcept>
+#include <unordered_map>
+
 namespace clickhouse {
 
+QuerySettings& QuerySettings::Set(const std::string& name, uint64_t value) {
+    if (TypeOf(name) == Type::String) {
+        throw std::logic_error("setting " + name + " must be set as a string");
+    }
+    values_[name] = value;
+    return *this;
+}
+
+QuerySettings& QuerySettings::Set(const std::string& name, std::string value) {
+    if (TypeOf(name) == Type::Number) {
+        throw std::logic_error("setting " + name + " must be set as a number");
+    }
+    values_[name] = std::move(value);
+    return *this;
+}
+
+QuerySettings::Type QuerySettings::TypeOf(const std::string& name) {
+    // Common settings of the server at the protocol revision of the client.
+    // The server reads the value of a setting by its type, so a value of
+    // another type breaks the stream.
+    static const std::unordered_map<std::string, Type> kSettings = [] () {
+        std::unordered_map<std::string, Type> settings;
+
+        // Integers and booleans.
+        for (const char* name : {
+            "connect_timeout",
+            "distributed_aggregation_memory_efficient",
+            "distributed_group_by_no_merge",
+            "extremes",
+            "force_index_by_date",
+            "force_primary_key",
+            "group_by_two_level_threshold",
+            "group_by_two_level_threshold_bytes",
+            "insert_deduplicate",
+            "insert_quorum",
+            "join_use_nulls",
+            "log_queries",
+            "max_block_size",
+            "max_bytes_before_external_group_by",
+            "max_bytes_before_external_sort",
+            "max_bytes_to_read",
+            "max_columns_to_read",
+            "max_compress_block_size",
+            "max_distributed_connections",
+            "max_execution_time",
+            "max_insert_block_size",
+            "max_memory_usage",
+            "max_memory_usage_for_user",
+            "max_network_bandwidth",
+            "max_parallel_replicas",
+            "max_query_size",
+            "max_read_buffer_size",
+            "max_result_bytes",
+            "max_result_rows",
+            "max_rows_to_group_by",
+            "max_rows_to_read",
+            "max_threads",
+            "min_compress_block_size",
+            "min_insert_block_size_bytes",
+            "min_insert_block_size_rows",
+            "optimize_move_to_prewhere",
+            "output_format_write_statistics",
+            "preferred_block_size_bytes",
+            "preferred_max_column_in_block_size_bytes",
+            "priority",
+            "readonly",
+            "receive_timeout",
+            "select_sequential_consistency",
+            "send_timeout",
+            "skip_unavailable_shards",
+            "use_client_time_zone",
+            "use_uncompressed_cache",
+        }) {
+            settings.emplace(name, Type::Number);
+        }
+
+        // Enumerations, floats, strings and characters.
+        for (const char* name : {
+            "count_distinct_implementation",
+            "date_time_input_format",
+            "distinct_overflow_mode",
+            "distributed_product_mode",
+            "format_csv_delimiter",
+            "format_schema",
+            "group_by_overflow_mode",
+            "input_format_allow_errors_ratio",
+            "join_default_strictness",
+            "join_overflow_mode",
+            "load_balancing",
+            "max_streams_multiplier_for_merge_tables",
+            "max_streams_to_max_threads_ratio",
+            "memory_tracker_fault_probability",
+            "network_compression_method",
+            "read_overflow_mode",
+            "result_overflow_mode",
+            "send_logs_level",
+            "set_overflow_mode",
+            "sort_overflow_mode",
+            "timeout_overflow_mode",
+            "totals_auto_threshold",
+            "totals_mode",
+            "transfer_overflow_mode",
+        }) {
+            settings.emplace(name, Type::String);
+        }
+
+        return settings;
+    }();
+
+    auto it = kSettings.find(name);
+    return it != kSettings.end() ? it->second : Type::Unknown;
+}
+
 Query::Query()
 { }
 
@@ -45,7 +161,9 @@ void Query::OnServerException(const Exception& e) {
 }
 
 void Query::OnProfile(const Profile& profile) {
-    (void)profile;
+    if (profile_cb_) {
+        profile_cb_(profile);
+    }
 }
 
 void Query::OnProgress(const Progress& progress) {
@@ -63,4 +181,30 @@ void Query::OnTotals(const Block& block) {
     }
 }
 
+void* Query::OnColumnMemory(const std::string& name, TypeRef type,
+                            size_t rows, size_t size) {
+    if (column_memory_cb_) {
+        return column_memory_cb_(name, type, rows, size);
+    }
+    return nullptr;
+}
+
+std::pmr::memory_resource* Query::MemoryResource() {
+    return memory_resource_;
+}
+
+bool Query::ReuseColumns() {
+    return reuse_columns_;
+}
+
+bool Query::WantsStats() {
+    return static_cast<bool>(stats_cb_);
+}
+
+void Query::OnStats(const QueryStats& stats) {
+    if (stats_cb_) {
+        stats_cb_(stats);
+    }
+}
+
 } // namespace clickhouse
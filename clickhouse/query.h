@@ -2,34 +2,60 @@
 
 #include "block.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <variant>
 
 namespace clickhouse {
 
 /**
- * Settings of individual query.
+ * Settings of individual query, e.g. max_block_size, max_threads or
+ * preferred_block_size_bytes.  Numeric and boolean settings must be set
+ * as numbers and are sent as such; enumerations, floats and strings are
+ * sent as strings.  Zero value of max_threads means "auto".
+ *
+ * Settings unknown to the client are sent in the type they are set with.
  */
-struct QuerySettings {
-    /// A maximum number of threads for query execution. Determined automatically by default.
-    int max_threads = 0;
-    /// Calculate minimum and maximum values of each column.
-    bool extremes = false;
-    /// Silently skip unavailable shards.
-    bool skip_unavailable_shards = false;
-    /// Write statistics about read rows, bytes, time elapsed, etc.
-    bool output_format_write_statistics = true;
-    /// Use client timezone for interpreting DateTime string values, instead of adopting server timezone.
-    bool use_client_time_zone = false;
-
-    // connect_timeout
-    // max_block_size
-    // distributed_group_by_no_merge = false
-    // strict_insert_defaults = 0
-    // network_compression_method = LZ4
-    // priority = 0
+class QuerySettings {
+public:
+    using Value = std::variant<uint64_t, std::string>;
+
+    /// Type in which the server expects the value of a setting.
+    enum class Type {
+        Unknown,
+        Number,
+        String,
+    };
+
+    /// Set a numeric or boolean setting.  Throws std::logic_error
+    /// if the setting is known to be sent as a string.
+    QuerySettings& Set(const std::string& name, uint64_t value);
+
+    /// Set a setting with a string value.  Throws std::logic_error
+    /// if the setting is known to be sent as a number.
+    QuerySettings& Set(const std::string& name, std::string value);
+
+    /// Type of the setting, if it is known to the client.
+    static Type TypeOf(const std::string& name);
+
+    /// Value of the setting, or nullptr if it has not been set.
+    inline const Value* Get(const std::string& name) const {
+        auto it = values_.find(name);
+        return it != values_.end() ? &it->second : nullptr;
+    }
+
+    /// All settings ordered by name.
+    inline const std::map<std::string, Value>& Values() const {
+        return values_;
+    }
+
+private:
+    std::map<std::string, Value> values_;
 };
 
 struct Exception {
@@ -56,6 +82,41 @@ struct Progress {
     uint64_t total_rows = 0;
 };
 
+/// Client-side statistics of a query.
+struct QueryStats {
+    /// Bytes received from and sent to the socket.
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+    /// Count of reads from and writes to the socket.
+    uint64_t socket_reads = 0;
+    uint64_t socket_writes = 0;
+    /// Size of received compressed frames and of data decompressed from them.
+    uint64_t compressed_bytes = 0;
+    uint64_t uncompressed_bytes = 0;
+    /// Received blocks with rows and count of the rows.
+    uint64_t blocks = 0;
+    uint64_t rows = 0;
+    /// Allocations for columns of received blocks from the default memory
+    /// resource.  Allocations from a resource set by the query are not counted.
+    /// Counted only when the query has a handler of statistics.
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+
+    /// Time spent in reading the socket, including waiting for data.
+    std::chrono::nanoseconds read_time{0};
+    /// Time spent in writing to the socket.
+    std::chrono::nanoseconds write_time{0};
+    /// Time spent in checksum verification and decompression of received data.
+    std::chrono::nanoseconds decompress_time{0};
+    /// Time spent in parsing of received blocks and loading of their columns,
+    /// excluding reads of the socket and decompression.
+    std::chrono::nanoseconds load_time{0};
+    /// Time spent in callbacks which received blocks are passed to.
+    std::chrono::nanoseconds callback_time{0};
+    /// Time from sending of the query to the end of its result.
+    std::chrono::nanoseconds total_time{0};
+};
+
 class QueryEvents {
 public:
     virtual ~QueryEvents() = default;
@@ -77,13 +138,47 @@ public:
 
     /// A block with totals values has been received.
     virtual void OnTotals(const Block& block) = 0;
+
+    /// Memory for \p rows of a fixed-width column of a block being received,
+    /// or nullptr to let the column allocate the rows itself.
+    virtual void* OnColumnMemory(const std::string& /*name*/, TypeRef /*type*/,
+                                 size_t /*rows*/, size_t /*size*/) {
+        return nullptr;
+    }
+
+    /// Memory resource for columns of received blocks.
+    virtual std::pmr::memory_resource* MemoryResource() {
+        return std::pmr::get_default_resource();
+    }
+
+    /// Whether columns of a received block can be reused by the next one.
+    virtual bool ReuseColumns() {
+        return false;
+    }
+
+    /// Whether statistics of the query are wanted.  Allocations are
+    /// counted only for such queries.
+    virtual bool WantsStats() {
+        return false;
+    }
+
+    /// Statistics of the query, after its result has been received
+    /// completely or an exception has been received instead.
+    virtual void OnStats(const QueryStats& /*stats*/) {
+    }
 };
 
 using DataCallback = std::function<void(const Block& block)>;
 using ExceptionCallback = std::function<void(const Exception& e)>;
+using ProfileCallback = std::function<void(const Profile& profile)>;
 using ProgressCallback = std::function<void(const Progress& progress)>;
+using StatsCallback = std::function<void(const QueryStats& stats)>;
 using SelectCallback = DataCallback;
 using SelectCancelableCallback = std::function<bool(const Block& block)>;
+/// Returns memory of \p size bytes for rows of the column \p name,
+/// or nullptr to keep the rows in memory of the column.
+using ColumnMemoryCallback = std::function<void*(const std::string& name, TypeRef type,
+                                                 size_t rows, size_t size)>;
 
 class Query : public QueryEvents {
 public:
@@ -97,6 +192,22 @@ public:
         return query_;
     }
 
+    /// Set a setting of the query, which overrides the setting
+    /// of the client with the same name.
+    inline Query& SetSetting(const std::string& name, uint64_t value) {
+        settings_.Set(name, value);
+        return *this;
+    }
+
+    inline Query& SetSetting(const std::string& name, std::string value) {
+        settings_.Set(name, std::move(value));
+        return *this;
+    }
+
+    inline const QuerySettings& GetSettings() const {
+        return settings_;
+    }
+
     /// Set handler for receiving result data.
     inline Query& OnData(DataCallback cb) {
         select_cb_ = cb;
@@ -120,18 +231,55 @@ public:
         return *this;
     }
 
+    /// Set handler for receiving profiling info of the query: rows, blocks
+    /// and bytes of the result and rows before LIMIT.
+    inline Query& OnProfile(ProfileCallback cb) {
+        profile_cb_ = cb;
+        return *this;
+    }
+
     /// Set handler for receiving a progress of query exceution.
     inline Query& OnProgress(ProgressCallback cb) {
         progress_cb_ = cb;
         return *this;
     }
 
+    /// Set handler for receiving client-side statistics of the query.
+    inline Query& OnStats(StatsCallback cb) {
+        stats_cb_ = cb;
+        return *this;
+    }
+
     /// Set handler for receiving totals values.
     inline Query& OnTotals(DataCallback cb) {
         totals_cb_ = cb;
         return *this;
     }
 
+    /// Set provider of memory for rows of numeric and other fixed-width
+    /// columns.  Rows are read from the network directly into the memory,
+    /// which must stay valid while the received block is in use.
+    inline Query& OnColumnMemory(ColumnMemoryCallback cb) {
+        column_memory_cb_ = cb;
+        return *this;
+    }
+
+    /// Set memory resource which columns of received blocks allocate
+    /// their rows from, e.g. an arena released at once after the query.
+    /// The resource must outlive all blocks of the query.
+    inline Query& SetMemoryResource(std::pmr::memory_resource* resource) {
+        memory_resource_ = resource;
+        return *this;
+    }
+
+    /// Load every received block into the columns of the previous one,
+    /// keeping their memory, instead of creating new columns.  A block
+    /// is valid only until the next block of the query is received.
+    inline Query& SetReuseColumns(bool value) {
+        reuse_columns_ = value;
+        return *this;
+    }
+
 private:
     void OnData(const Block& block) override;
 
@@ -149,14 +297,31 @@ private:
 
     void OnTotals(const Block& block) override;
 
+    void* OnColumnMemory(const std::string& name, TypeRef type,
+                         size_t rows, size_t size) override;
+
+    std::pmr::memory_resource* MemoryResource() override;
+
+    bool ReuseColumns() override;
+
+    bool WantsStats() override;
+
+    void OnStats(const QueryStats& stats) override;
+
 private:
     std::string query_;
+    QuerySettings settings_;
     ExceptionCallback exception_cb_;
+    ProfileCallback profile_cb_;
     ProgressCallback progress_cb_;
     DataCallback select_cb_;
     SelectCancelableCallback select_cancelable_cb_;
     DataCallback totals_cb_;
     DataCallback extremes_cb_;
+    StatsCallback stats_cb_;
+    ColumnMemoryCallback column_memory_cb_;
+    std::pmr::memory_resource* memory_resource_ = std::pmr::get_default_resource();
+    bool reuse_columns_ = false;
 };
 
 } // namespace clickhouse
@@ -1,8 +1,8 @@
 #include "type_parser.h"
 #include "../base/string_utils.h"
 
-#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace clickhouse {
@@ -192,22 +192,35 @@ TypeParser::Token TypeParser::NextToken() {
 const TypeAst* ParseTypeName(const std::string& type_name) {
     // Cache for type_name.
     // Usually we won't have too many type names in the cache, so do not try to
-    // limit cache size.
-    static std::map<std::string, TypeAst> ast_cache;
-    static std::mutex lock;
-
-    std::lock_guard<std::mutex> guard(lock);
-    auto it = ast_cache.find(type_name);
-    if (it != ast_cache.end()) {
-        return &it->second;
+    // limit cache size.  Entries are never removed, so pointers to them stay
+    // valid and every thread can keep its own copy of the index without locks.
+    static std::unordered_map<std::string, TypeAst> ast_cache;
+    static std::shared_mutex lock;
+    thread_local std::unordered_map<std::string, const TypeAst*> local_cache;
+
+    auto li = local_cache.find(type_name);
+    if (li != local_cache.end()) {
+        return li->second;
     }
 
-    auto& ast = ast_cache[type_name];
-    if (TypeParser(type_name).Parse(&ast)) {
-        return &ast;
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        auto it = ast_cache.find(type_name);
+        if (it != ast_cache.end()) {
+            local_cache.emplace(type_name, &it->second);
+            return &it->second;
+        }
+    }
+
+    TypeAst ast;
+    if (!TypeParser(type_name).Parse(&ast)) {
+        return nullptr;
     }
-    ast_cache.erase(type_name);
-    return nullptr;
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    const TypeAst* result = &ast_cache.emplace(type_name, std::move(ast)).first->second;
+    local_cache.emplace(type_name, result);
+    return result;
 }
 
 }
@@ -164,17 +164,136 @@ std::string Type::GetName() const {
 }
 
 bool Type::IsEqual(const TypeRef& other) const {
-    return this->GetName() == other->GetName();
+    if (this == other.get()) {
+        return true;
+    }
+    if (code_ != other->code_) {
+        return false;
+    }
+
+    switch (code_) {
+        case FixedString:
+            return string_size_ == other->string_size_;
+        case DateTime:
+            return date_time_->timezone == other->date_time_->timezone;
+        case DateTime64:
+            return date_time_->precision == other->date_time_->precision &&
+                   date_time_->timezone == other->date_time_->timezone;
+        case Array:
+            return array_->item_type->IsEqual(other->array_->item_type);
+        case Nullable:
+            return nullable_->nested_type->IsEqual(other->nullable_->nested_type);
+        case Tuple: {
+            const auto& items = tuple_->item_types;
+            const auto& other_items = other->tuple_->item_types;
+
+            if (items.size() != other_items.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (!items[i]->IsEqual(other_items[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case Enum8:
+        case Enum16:
+            return enum_->value_to_name == other->enum_->value_to_name;
+        case Decimal:
+        case Decimal32:
+        case Decimal64:
+        case Decimal128:
+            return decimal_->precision == other->decimal_->precision &&
+                   decimal_->scale == other->decimal_->scale;
+        default:
+            // Types without parameters.
+            return true;
+    }
+}
+
+namespace {
+
+/// Codes of types without parameters.
+static const Type::Code kSimpleCodes[] = {
+    Type::Void,
+    Type::Int8,
+    Type::Int16,
+    Type::Int32,
+    Type::Int64,
+    Type::Int128,
+    Type::UInt8,
+    Type::UInt16,
+    Type::UInt32,
+    Type::UInt64,
+    Type::Float32,
+    Type::Float64,
+    Type::String,
+    Type::Date,
+    Type::UUID,
+    Type::IPv4,
+    Type::IPv6,
+};
+
+static const size_t kCodeCount = Type::Decimal128 + 1;
+
+}
+
+TypeRef Type::GetSimple(Code code) {
+    static const std::vector<TypeRef> types = [] {
+        std::vector<TypeRef> result(kCodeCount);
+        for (const Code c : kSimpleCodes) {
+            result[c] = TypeRef(new Type(c));
+        }
+        return result;
+    }();
+
+    assert(types[code]);
+    return types[code];
+}
+
+TypeRef Type::GetShared(Code code, const TypeRef& nested) {
+    // Arrays and nullables of simple types, indexed by code of the nested type.
+    struct SharedTypes {
+        std::vector<TypeRef> arrays;
+        std::vector<TypeRef> nullables;
+
+        SharedTypes()
+            : arrays(kCodeCount)
+            , nullables(kCodeCount)
+        {
+            for (const Code c : kSimpleCodes) {
+                arrays[c] = TypeRef(new Type(Type::Array));
+                arrays[c]->array_->item_type = GetSimple(c);
+
+                nullables[c] = TypeRef(new Type(Type::Nullable));
+                nullables[c]->nullable_->nested_type = GetSimple(c);
+            }
+        }
+    };
+    static const SharedTypes shared;
+
+    const auto& types = (code == Array) ? shared.arrays : shared.nullables;
+    const TypeRef& type = types[nested->code_];
+
+    if (type && (code == Array ? type->array_->item_type : type->nullable_->nested_type) == nested) {
+        return type;
+    }
+    return TypeRef();
 }
 
 TypeRef Type::CreateArray(TypeRef item_type) {
+    if (TypeRef shared = GetShared(Type::Array, item_type)) {
+        return shared;
+    }
+
     TypeRef type(new Type(Type::Array));
     type->array_->item_type = item_type;
     return type;
 }
 
 TypeRef Type::CreateDate() {
-    return TypeRef(new Type(Type::Date));
+    return GetSimple(Type::Date);
 }
 
 TypeRef Type::CreateDateTime(std::string timezone) {
@@ -198,25 +317,29 @@ TypeRef Type::CreateDecimal(size_t precision, size_t scale) {
 }
 
 TypeRef Type::CreateIPv4() {
-    return TypeRef(new Type(Type::IPv4));
+    return GetSimple(Type::IPv4);
 }
 
 TypeRef Type::CreateIPv6() {
-    return TypeRef(new Type(Type::IPv6));
+    return GetSimple(Type::IPv6);
 }
 
 TypeRef Type::CreateNothing() {
-    return TypeRef(new Type(Type::Void));
+    return GetSimple(Type::Void);
 }
 
 TypeRef Type::CreateNullable(TypeRef nested_type) {
+    if (TypeRef shared = GetShared(Type::Nullable, nested_type)) {
+        return shared;
+    }
+
     TypeRef type(new Type(Type::Nullable));
     type->nullable_->nested_type = nested_type;
     return type;
 }
 
 TypeRef Type::CreateString() {
-    return TypeRef(new Type(Type::String));
+    return GetSimple(Type::String);
 }
 
 TypeRef Type::CreateString(size_t n) {
@@ -250,7 +373,7 @@ TypeRef Type::CreateEnum16(const std::vector<EnumItem>& enum_items) {
 }
 
 TypeRef Type::CreateUUID() {
-    return TypeRef(new Type(Type::UUID));
+    return GetSimple(Type::UUID);
 }
 
 
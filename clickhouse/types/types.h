@@ -68,7 +68,8 @@ public:
     /// String representation of the type.
     std::string GetName() const;
 
-    /// Is given type same as current one.
+    /// Is given type same as current one.  Types are compared by structure,
+    /// shared instances are recognized by address.
     bool IsEqual(const TypeRef& other) const;
 
 public:
@@ -108,6 +109,15 @@ public:
 private:
     Type(const Code code);
 
+    /// Returns the shared instance of a type without parameters.
+    /// Types are immutable, so all columns of such type refer to
+    /// the same instance and no allocation is needed to create it.
+    static TypeRef GetSimple(Code code);
+
+    /// Returns the shared instance of Array or Nullable of \p nested
+    /// if \p nested is a shared instance itself, nullptr otherwise.
+    static TypeRef GetShared(Code code, const TypeRef& nested);
+
     struct ArrayImpl {
         TypeRef item_type;
     };
@@ -188,57 +198,57 @@ private:
 
 template <>
 inline TypeRef Type::CreateSimple<int8_t>() {
-    return TypeRef(new Type(Int8));
+    return GetSimple(Int8);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<int16_t>() {
-    return TypeRef(new Type(Int16));
+    return GetSimple(Int16);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<int32_t>() {
-    return TypeRef(new Type(Int32));
+    return GetSimple(Int32);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<int64_t>() {
-    return TypeRef(new Type(Int64));
+    return GetSimple(Int64);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<absl::int128>() {
-    return TypeRef(new Type(Int128));
+    return GetSimple(Int128);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<uint8_t>() {
-    return TypeRef(new Type(UInt8));
+    return GetSimple(UInt8);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<uint16_t>() {
-    return TypeRef(new Type(UInt16));
+    return GetSimple(UInt16);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<uint32_t>() {
-    return TypeRef(new Type(UInt32));
+    return GetSimple(UInt32);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<uint64_t>() {
-    return TypeRef(new Type(UInt64));
+    return GetSimple(UInt64);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<float>() {
-    return TypeRef(new Type(Float32));
+    return GetSimple(Float32);
 }
 
 template <>
 inline TypeRef Type::CreateSimple<double>() {
-    return TypeRef(new Type(Float64));
+    return GetSimple(Float64);
 }
 
 }
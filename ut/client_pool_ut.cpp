@@ -0,0 +1,118 @@
+#include "fake_server.h"
+
+#include <clickhouse/client_pool.h>
+#include <contrib/gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace clickhouse;
+
+static const int kPort = 19300;
+
+static ClientPoolOptions MakePoolOptions() {
+    return ClientPoolOptions()
+        .SetClientOptions(ClientOptions().SetHost("localhost").SetPort(kPort))
+        .SetSize(2)
+        .SetAcquireTimeout(std::chrono::milliseconds(100));
+}
+
+class ClientPoolCase : public testing::Test {
+protected:
+    void SetUp() override {
+        FakeServerScript script;
+        script.block = MakeSyntheticBlock({"UInt64"}, 10);
+        script.blocks = 1;
+
+        server_.reset(new FakeServer(kPort));
+        server_->SetScript(script);
+    }
+
+    void TearDown() override {
+        server_.reset();
+    }
+
+    std::unique_ptr<FakeServer> server_;
+};
+
+TEST_F(ClientPoolCase, AcquireRelease) {
+    ClientPool pool(MakePoolOptions());
+    ASSERT_EQ(pool.Idle(), 2u);
+
+    {
+        auto a = pool.Acquire();
+        auto b = pool.Acquire();
+        ASSERT_EQ(pool.Idle(), 0u);
+
+        EXPECT_THROW(pool.Acquire(), std::runtime_error);
+
+        a->Ping();
+        b->Ping();
+    }
+
+    ASSERT_EQ(pool.Idle(), 2u);
+}
+
+TEST_F(ClientPoolCase, ReplaceBroken) {
+    ClientPool pool(MakePoolOptions().SetAcquireTimeout(std::chrono::seconds(10)));
+
+    {
+        auto lease = pool.Acquire();
+        lease.Invalidate();
+    }
+
+    // The broken connection is recreated in the background.
+    auto a = pool.Acquire();
+    auto b = pool.Acquire();
+    a->Ping();
+    b->Ping();
+}
+
+TEST_F(ClientPoolCase, Concurrent) {
+    ClientPool pool(MakePoolOptions().SetAcquireTimeout(std::chrono::seconds(10)));
+    std::atomic<uint64_t> rows(0);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&pool, &rows] () {
+            for (int j = 0; j < 10; ++j) {
+                auto client = pool.Acquire();
+                client->Select("SELECT c0 FROM fake",
+                    [&rows] (const Block& block) { rows += block.GetRowCount(); });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(800u, rows.load());
+}
+
+TEST_F(ClientPoolCase, ReleaseBusy) {
+    ClientPool pool(MakePoolOptions().SetAcquireTimeout(std::chrono::seconds(10)));
+
+    {
+        auto lease = pool.Acquire();
+        lease->BeginSelect(Query("SELECT c0 FROM fake"));
+    }
+
+    // The connection with unfinished select is not returned to the pool.
+    ASSERT_EQ(pool.Idle(), 1u);
+
+    auto a = pool.Acquire();
+    auto b = pool.Acquire();
+    a->Ping();
+    b->Ping();
+}
+
+TEST_F(ClientPoolCase, LeaseOutlivesPool) {
+    std::unique_ptr<ClientPool> pool(new ClientPool(MakePoolOptions()));
+    auto lease = pool->Acquire();
+
+    pool.reset();
+
+    // The connection stays usable and is closed on release.
+    lease->Ping();
+}
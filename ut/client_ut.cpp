@@ -1,6 +1,10 @@
+#include <clickhouse/async_client.h>
 #include <clickhouse/client.h>
 #include <contrib/gtest/gtest.h>
 
+#include <atomic>
+#include <set>
+
 using namespace clickhouse;
 
 // Use value-parameterized tests to run same tests with different client
@@ -248,6 +252,186 @@ TEST_P(ClientCase, Numbers) {
     EXPECT_EQ(100000U, num);
 }
 
+TEST_P(ClientCase, InsertStream) {
+    /// Create a table.
+    client_->Execute(
+            "CREATE TABLE IF NOT EXISTS test.stream (x UInt64, s String) "
+            "ENGINE = Memory");
+
+    /// Stream a few blocks within a single insert query.
+    const uint64_t kBlock = 5;
+    const uint64_t kRowEachBlock = 1000;
+
+    client_->BeginInsert("test.stream", {"x", "s"});
+    EXPECT_THROW(client_->Execute("SELECT 1"), std::logic_error);
+    for (uint64_t j = 0; j < kBlock; j++) {
+        Block b;
+
+        auto x = std::make_shared<ColumnUInt64>();
+        auto s = std::make_shared<ColumnString>();
+        for (uint64_t i = 0; i < kRowEachBlock; i++) {
+            x->Append(j * kRowEachBlock + i);
+            s->Append(std::to_string(i));
+        }
+
+        b.AppendColumn("x", x);
+        b.AppendColumn("s", s);
+        client_->InsertData(b);
+    }
+    client_->EndInsert();
+
+    uint64_t sum = 0;
+    size_t rows = 0;
+    client_->Select("SELECT x FROM test.stream", [&sum, &rows](const Block& block)
+        {
+            for (size_t i = 0; i < block.GetRowCount(); ++i, ++rows) {
+                sum += (*block[0]->As<ColumnUInt64>())[i];
+            }
+        }
+    );
+
+    const uint64_t total = kBlock * kRowEachBlock;
+    EXPECT_EQ(total, rows);
+    EXPECT_EQ(total * (total - 1) / 2, sum);
+}
+
+TEST_P(ClientCase, SelectPull) {
+    /// Pull the result block by block.
+    Block block;
+    uint64_t sum = 0;
+    size_t rows = 0;
+
+    client_->BeginSelect(Query(
+        "SELECT number FROM system.numbers LIMIT 100000 SETTINGS max_block_size = 1000"));
+    EXPECT_THROW(client_->Execute("SELECT 1"), std::logic_error);
+    while (client_->ReceiveBlock(&block)) {
+        EXPECT_GT(block.GetRowCount(), 0U);
+        for (size_t i = 0; i < block.GetRowCount(); ++i, ++rows) {
+            sum += (*block[0]->As<ColumnUInt64>())[i];
+        }
+    }
+    client_->EndSelect();
+
+    EXPECT_EQ(100000U, rows);
+    EXPECT_EQ(100000ULL * 99999 / 2, sum);
+
+    /// Stop reading in the middle of an infinite result.
+    client_->BeginSelect(Query("SELECT number FROM system.numbers"));
+    ASSERT_TRUE(client_->ReceiveBlock(&block));
+    client_->EndSelect();
+
+    /// The connection can be used again.
+    client_->Ping();
+}
+
+TEST_P(ClientCase, ColumnMemory) {
+    /// Rows of numeric columns are read into memory of the application.
+    std::vector<uint64_t> numbers;
+    size_t blocks = 0;
+
+    client_->Select(Query(
+        "SELECT number, toString(number) FROM system.numbers LIMIT 10000 SETTINGS max_block_size = 1000")
+        .OnColumnMemory([&numbers] (const std::string&, TypeRef type, size_t rows, size_t size) -> void* {
+            EXPECT_EQ(Type::UInt64, type->GetCode());
+            EXPECT_EQ(rows * sizeof(uint64_t), size);
+            numbers.resize(rows);
+            return numbers.data();
+        })
+        .OnData([&numbers, &blocks] (const Block& block) {
+            if (block.GetRowCount() == 0) {
+                return;
+            }
+            auto col = block[0]->As<ColumnUInt64>();
+            EXPECT_EQ(numbers.data(), &(*col)[0]);
+            EXPECT_EQ(blocks * 1000, numbers[0]);
+            EXPECT_EQ(std::to_string(numbers.back()),
+                      block[1]->As<ColumnString>()->At(block.GetRowCount() - 1));
+            ++blocks;
+        }));
+
+    EXPECT_EQ(10U, blocks);
+}
+
+TEST_P(ClientCase, MemoryResource) {
+    /// Columns of the result are allocated from an arena of the query.
+    std::pmr::monotonic_buffer_resource arena;
+    uint64_t sum = 0;
+
+    client_->Select(Query("SELECT number, toString(number) FROM system.numbers LIMIT 1000")
+        .SetMemoryResource(&arena)
+        .OnData([&sum] (const Block& block) {
+            for (size_t i = 0; i < block.GetRowCount(); ++i) {
+                sum += (*block[0]->As<ColumnUInt64>())[i];
+            }
+        }));
+
+    EXPECT_EQ(1000ULL * 999 / 2, sum);
+}
+
+TEST_P(ClientCase, ReuseColumns) {
+    /// All blocks of the result are loaded into the same columns.
+    std::set<const Column*> columns;
+    uint64_t sum = 0;
+    size_t rows = 0;
+
+    client_->Select(Query(
+        "SELECT number, toString(number), (number, toString(number)), [number, number + 1], "
+        "toNullable(number) FROM system.numbers LIMIT 10000 SETTINGS max_block_size = 1000")
+        .SetReuseColumns(true)
+        .OnData([&] (const Block& block) {
+            if (block.GetRowCount() == 0) {
+                return;
+            }
+            for (size_t c = 0; c < block.GetColumnCount(); ++c) {
+                columns.insert(block[c].get());
+                EXPECT_EQ(block.GetRowCount(), block[c]->Size());
+            }
+
+            auto tuple = block[2]->As<ColumnTuple>();
+            auto array = block[3]->As<ColumnArray>();
+            auto nullable = block[4]->As<ColumnNullable>();
+
+            for (size_t i = 0; i < block.GetRowCount(); ++i, ++rows) {
+                const uint64_t number = (*block[0]->As<ColumnUInt64>())[i];
+
+                // Composite columns are cleared, not emptied of their
+                // nested columns, before the next block.
+                EXPECT_EQ(number, (*tuple)[0]->As<ColumnUInt64>()->At(i));
+                EXPECT_EQ(std::to_string(number), (*tuple)[1]->As<ColumnString>()->At(i));
+                EXPECT_EQ(number + 1, array->GetAsColumn(i)->As<ColumnUInt64>()->At(1));
+                EXPECT_EQ(number, nullable->Nested()->As<ColumnUInt64>()->At(i));
+                sum += number;
+            }
+        }));
+
+    EXPECT_EQ(5U, columns.size());
+    EXPECT_EQ(10000U, rows);
+    EXPECT_EQ(10000ULL * 9999 / 2, sum);
+}
+
+TEST_P(ClientCase, AsyncSelect) {
+    AsyncClient async(GetParam(), 4);
+    std::vector<std::future<void>> results;
+    std::atomic<size_t> rows(0);
+
+    for (int i = 0; i < 16; ++i) {
+        results.push_back(async.Select(
+            "SELECT number, toString(number) FROM system.numbers LIMIT 100000",
+            [&rows](const Block& block) { rows += block.GetRowCount(); }));
+    }
+
+    auto failed = async.Execute(Query("SELECT * FROM test.table_does_not_exist"));
+
+    for (auto& r : results) {
+        r.get();
+    }
+    EXPECT_THROW(failed.get(), ServerException);
+    EXPECT_EQ(16u * 100000u, rows.load());
+
+    /// The connection is reusable after a server exception.
+    async.Select("SELECT 1", [](const Block&) {}).get();
+}
+
 TEST_P(ClientCase, Cancelable) {
     /// Create a table.
     client_->Execute(
@@ -368,6 +552,10 @@ INSTANTIATE_TEST_CASE_P(
         ClientOptions()
             .SetHost("localhost")
             .SetPingBeforeQuery(false)
-            .SetCompressionMethod(CompressionMethod::LZ4)
+            .SetCompressionMethod(CompressionMethod::LZ4),
+        ClientOptions()
+            .SetHost("localhost")
+            .SetPingBeforeQuery(false)
+            .SetCompressionMethod(CompressionMethod::ZSTD)
     ));
 
@@ -5,10 +5,14 @@
 #include <clickhouse/columns/nullable.h>
 #include <clickhouse/columns/numeric.h>
 #include <clickhouse/columns/string.h>
+#include <clickhouse/columns/tuple.h>
 #include <clickhouse/columns/uuid.h>
 
 #include <contrib/gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace clickhouse;
 
 static std::vector<uint32_t> MakeNumbers() {
@@ -69,6 +73,269 @@ TEST(ColumnsCase, FixedStringInit) {
     ASSERT_EQ(col->At(3), "ddd");
 }
 
+TEST(ColumnsCase, FixedStringLoadSave) {
+    auto col = std::make_shared<ColumnFixedString>(3);
+    for (const auto& s : MakeFixedStrings()) {
+        col->Append(s);
+    }
+    col->Append("abcdef");
+    col->Append("z");
+
+    ASSERT_EQ(col->At(4), "abc");
+    ASSERT_EQ(col->At(5), std::string("z\0\0", 3));
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+    }
+    ASSERT_EQ(buf.size(), 18u);
+
+    auto loaded = std::make_shared<ColumnFixedString>(3);
+    {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        ASSERT_TRUE(loaded->Load(&coded, col->Size()));
+    }
+
+    ASSERT_EQ(loaded->Size(), 6u);
+    ASSERT_EQ(loaded->At(0), "aaa");
+    ASSERT_EQ(loaded->At(4), "abc");
+
+    auto sub = loaded->Slice(3, 2)->As<ColumnFixedString>();
+    ASSERT_EQ(sub->Size(), 2u);
+    ASSERT_EQ(sub->At(0), "ddd");
+    ASSERT_EQ(sub->At(1), "abc");
+}
+
+TEST(ColumnsCase, NumericLoadInto) {
+    auto col = std::make_shared<ColumnUInt32>(MakeNumbers());
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+    }
+
+    auto loaded = std::make_shared<ColumnUInt32>();
+    ASSERT_EQ(loaded->FixedRowSize(), sizeof(uint32_t));
+
+    std::vector<uint32_t> memory(col->Size());
+    {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        ASSERT_TRUE(loaded->LoadInto(&coded, col->Size(), memory.data()));
+    }
+
+    ASSERT_EQ(memory, MakeNumbers());
+    ASSERT_EQ(loaded->Size(), col->Size());
+    ASSERT_EQ(&(*loaded)[0], memory.data());
+    ASSERT_EQ(loaded->Slice(3, 2)->As<ColumnUInt32>()->At(1), 11u);
+
+    // Modification copies rows into the column.
+    loaded->Append(37);
+    memory[0] = 100;
+    ASSERT_EQ(loaded->Size(), 12u);
+    ASSERT_EQ(loaded->At(0), 1u);
+    ASSERT_EQ(loaded->At(11), 37u);
+}
+
+/// Counts bytes allocated through the resource.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        allocated -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST(ColumnsCase, MemoryResource) {
+    CountingResource resource;
+    {
+        auto col = CreateColumnByType(
+            "Tuple(Array(Nullable(UInt32)), String, FixedString(4), Date, Enum8('a' = 1))", &resource);
+        ASSERT_NE(nullptr, col);
+
+        auto tuple = col->As<ColumnTuple>();
+        auto array = (*tuple)[0]->As<ColumnArray>();
+        auto numbers = std::make_shared<ColumnNullable>(
+            std::make_shared<ColumnUInt32>(MakeNumbers()),
+            std::make_shared<ColumnUInt8>(MakeBools()));
+        array->AppendAsColumn(numbers);
+        (*tuple)[1]->As<ColumnString>()->Append("string");
+        (*tuple)[2]->As<ColumnFixedString>()->Append("abcd");
+        (*tuple)[3]->As<ColumnDate>()->Append(86400);
+        (*tuple)[4]->As<ColumnEnum8>()->Append(1);
+
+        // Offsets, null map, nested rows, chars and fixed-width rows.
+        EXPECT_GE(resource.allocated,
+            sizeof(uint64_t) + 11 + 11 * sizeof(uint32_t) + 6 + 4 + sizeof(uint16_t) + 1);
+
+        // Slices allocate from the same resource.
+        const size_t before = resource.allocated;
+        auto slice = array->Slice(0, 1);
+        EXPECT_GT(resource.allocated, before);
+    }
+    EXPECT_EQ(0U, resource.allocated);
+}
+
+TEST(ColumnsCase, LoadIntoKeepsStorage) {
+    auto col = std::make_shared<ColumnUInt32>(MakeNumbers());
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+    }
+
+    auto load = [&buf, &col] (ColumnUInt32* loaded, void* memory) {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        return memory
+            ? loaded->LoadInto(&coded, col->Size(), memory)
+            : loaded->Load(&coded, col->Size());
+    };
+
+    CountingResource resource;
+    ColumnUInt32 loaded(&resource);
+    std::vector<uint32_t> memory(col->Size());
+
+    ASSERT_TRUE(load(&loaded, nullptr));
+    const size_t allocated = resource.allocated;
+    ASSERT_GT(allocated, 0u);
+
+    // Storage of the column is kept for the next Load.
+    ASSERT_TRUE(load(&loaded, memory.data()));
+    ASSERT_EQ(resource.allocated, allocated);
+    ASSERT_TRUE(load(&loaded, nullptr));
+    ASSERT_EQ(resource.allocated, allocated);
+    ASSERT_EQ(loaded.At(10), col->At(10));
+}
+
+TEST(ColumnsCase, SliceConcurrentMutation) {
+    const size_t kRows = 4000;
+    const size_t kParts = 4;
+
+    for (int round = 0; round < 50; ++round) {
+        auto col = std::make_shared<ColumnUInt64>();
+        for (uint64_t i = 0; i < kRows; ++i) {
+            col->Append(i);
+        }
+
+        // Slices are read and released by other threads, while the column
+        // is cleared and filled again with other values.
+        std::atomic<size_t> mismatches{0};
+        std::vector<std::thread> readers;
+
+        for (size_t part = 0; part < kParts; ++part) {
+            ColumnRef slice = col->Slice(part * kRows / kParts, kRows / kParts);
+
+            readers.emplace_back([slice, part, &mismatches] () mutable {
+                auto numbers = slice->As<ColumnUInt64>();
+                for (size_t i = 0; i < numbers->Size(); ++i) {
+                    if ((*numbers)[i] != part * kRows / kParts + i) {
+                        ++mismatches;
+                    }
+                }
+                slice.reset();
+            });
+        }
+
+        for (uint64_t value = 1; value <= 10; ++value) {
+            col->Clear();
+            for (size_t i = 0; i < kRows; ++i) {
+                col->Append(value * kRows + i);
+            }
+        }
+
+        for (auto& reader : readers) {
+            reader.join();
+        }
+
+        ASSERT_EQ(mismatches.load(), 0u);
+        ASSERT_EQ(col->At(kRows - 1), 11 * kRows - 1);
+    }
+}
+
+TEST(ColumnsCase, SliceSharesRows) {
+    auto col = std::make_shared<ColumnUInt32>(MakeNumbers());
+    auto slice = col->Slice(2, 5)->As<ColumnUInt32>();
+
+    ASSERT_EQ(slice->Size(), 5u);
+    ASSERT_EQ(&(*slice)[0], &(*col)[2]);
+
+    // Modification of either column does not affect the other one.
+    slice->Append(100);
+    ASSERT_NE(&(*slice)[0], &(*col)[2]);
+    ASSERT_EQ(slice->Size(), 6u);
+    ASSERT_EQ(slice->At(5), 100u);
+    ASSERT_EQ(col->Size(), 11u);
+    ASSERT_EQ(col->At(7), 19u);
+
+    auto slice2 = col->Slice(9, 10)->As<ColumnUInt32>();
+    col->Clear();
+    col->Append(1);
+    ASSERT_EQ(slice2->Size(), 2u);
+    ASSERT_EQ(slice2->At(0), 29u);
+    ASSERT_EQ(slice2->At(1), 31u);
+}
+
+TEST(ColumnsCase, StringSliceSharesRows) {
+    auto col = std::make_shared<ColumnString>(MakeStrings());
+    auto slice = col->Slice(1, 2)->As<ColumnString>();
+
+    ASSERT_EQ(slice->Size(), 2u);
+    ASSERT_EQ(slice->At(0), "ab");
+    ASSERT_EQ(slice->At(1), "abc");
+    ASSERT_EQ(slice->At(0).data(), col->At(1).data());
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        slice->Save(&coded);
+    }
+    ASSERT_EQ(buf.size(), 7u);
+
+    slice->Append("z");
+    ASSERT_EQ(slice->Size(), 3u);
+    ASSERT_EQ(slice->At(1), "abc");
+    ASSERT_EQ(slice->At(2), "z");
+    ASSERT_EQ(col->Size(), 4u);
+    ASSERT_EQ(col->At(3), "abcd");
+
+    auto copy = std::make_shared<ColumnString>();
+    copy->Append(col->Slice(2, 2));
+    ASSERT_EQ(copy->Size(), 2u);
+    ASSERT_EQ(copy->At(0), "abc");
+    ASSERT_EQ(copy->At(1), "abcd");
+
+    auto fixed = std::make_shared<ColumnFixedString>(3);
+    for (const auto& s : MakeFixedStrings()) {
+        fixed->Append(s);
+    }
+    auto fixed_slice = fixed->Slice(1, 2)->As<ColumnFixedString>();
+    ASSERT_EQ(fixed_slice->At(0).data(), fixed->At(1).data());
+    fixed->Append("eee");
+    ASSERT_EQ(fixed_slice->Size(), 2u);
+    ASSERT_EQ(fixed_slice->At(1), "ccc");
+}
+
 TEST(ColumnsCase, StringInit) {
     auto col = std::make_shared<ColumnString>(MakeStrings());
 
@@ -78,6 +345,115 @@ TEST(ColumnsCase, StringInit) {
 }
 
 
+TEST(ColumnsCase, StringAppendSlice) {
+    auto col = std::make_shared<ColumnString>(MakeStrings());
+    col->Append(col->Slice(1, 2));
+    col->Append(std::string());
+
+    ASSERT_EQ(col->Size(), 7u);
+    ASSERT_EQ(col->At(4), "ab");
+    ASSERT_EQ(col->At(5), "abc");
+    ASSERT_EQ(col->At(6), "");
+
+    auto sub = col->Slice(2, 10)->As<ColumnString>();
+    ASSERT_EQ(sub->Size(), 5u);
+    ASSERT_EQ(sub->At(0), "abc");
+    ASSERT_EQ(sub->At(1), "abcd");
+    ASSERT_EQ(sub->At(4), "");
+    ASSERT_EQ(col->Slice(7, 1)->Size(), 0u);
+}
+
+TEST(ColumnsCase, StringLoadSave) {
+    auto col = std::make_shared<ColumnString>(MakeStrings());
+    col->Append(std::string(300, 'x'));
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+    }
+
+    auto loaded = std::make_shared<ColumnString>();
+    {
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        ASSERT_TRUE(loaded->Load(&coded, col->Size()));
+    }
+
+    ASSERT_EQ(loaded->Size(), col->Size());
+    for (size_t i = 0; i < col->Size(); ++i) {
+        ASSERT_EQ(loaded->At(i), col->At(i));
+    }
+}
+
+TEST(ColumnsCase, StringLoadBuffered) {
+    auto col = std::make_shared<ColumnString>();
+    for (size_t i = 0; i < 1000; ++i) {
+        col->Append(std::string(i % 37, char('a' + i % 26)));
+    }
+    col->Append(std::string(300, 'x'));
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+        coded.WriteVarint64(12345);
+    }
+
+    // Rows straddle refills of a small buffer.
+    for (size_t buflen : {1, 5, 16, 64, 8192}) {
+        ArrayInput array(buf.data(), buf.size());
+        BufferedInput input(&array, buflen);
+        CodedInputStream coded(&input);
+
+        auto loaded = std::make_shared<ColumnString>();
+        ASSERT_TRUE(loaded->Load(&coded, col->Size()));
+
+        ASSERT_EQ(loaded->Size(), col->Size());
+        for (size_t i = 0; i < col->Size(); ++i) {
+            ASSERT_EQ(loaded->At(i), col->At(i));
+        }
+
+        // Data following the column is left intact.
+        uint64_t tail;
+        ASSERT_TRUE(coded.ReadVarint64(&tail));
+        ASSERT_EQ(tail, 12345u);
+    }
+}
+
+TEST(ColumnsCase, StringLoadTruncated) {
+    auto col = std::make_shared<ColumnString>();
+    for (size_t i = 0; i < 100; ++i) {
+        col->Append(std::string(i % 37, char('a' + i % 26)));
+    }
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        col->Save(&coded);
+    }
+
+    // The data ends within a row, after rows parsed in bulk or byte by byte.
+    for (size_t buflen : {5, 8192}) {
+        ArrayInput array(buf.data(), buf.size() - 3);
+        BufferedInput input(&array, buflen);
+        CodedInputStream coded(&input);
+
+        ColumnString loaded;
+        loaded.Append("first");
+        ASSERT_FALSE(loaded.Load(&coded, col->Size()));
+
+        // Rows of the failed block are dropped.
+        ASSERT_EQ(loaded.Size(), 1u);
+        ASSERT_EQ(loaded.At(0), "first");
+        loaded.Append("second");
+        ASSERT_EQ(loaded.At(1), "second");
+    }
+}
+
 TEST(ColumnsCase, ArrayAppend) {
     auto arr1 = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
     auto arr2 = std::make_shared<ColumnArray>(std::make_shared<ColumnUInt64>());
@@ -98,6 +474,33 @@ TEST(ColumnsCase, ArrayAppend) {
     //ASSERT_EQ(col->As<ColumnUInt64>()->At(1), 3u);
 }
 
+TEST(ColumnsCase, ArraySlice) {
+    auto arr = std::make_shared<ColumnArray>(std::make_shared<ColumnString>());
+    const auto strings = MakeStrings();
+
+    // Rows of 0, 1, 2 and 1 elements.
+    for (const auto& row : std::vector<std::vector<std::string>>{
+            {}, {strings[0]}, {strings[1], strings[2]}, {strings[3]}}) {
+        arr->AppendAsColumn(std::make_shared<ColumnString>(row));
+    }
+    ASSERT_EQ(arr->Size(), 4u);
+
+    auto slice = arr->Slice(1, 2)->As<ColumnArray>();
+    ASSERT_EQ(slice->Size(), 2u);
+    ASSERT_EQ(slice->GetAsColumn(0)->Size(), 1u);
+    ASSERT_EQ(slice->GetAsColumn(1)->As<ColumnString>()->At(1), strings[2]);
+
+    ASSERT_EQ(arr->Slice(2, 100)->Size(), 2u);
+    ASSERT_EQ(arr->Slice(4, 1)->Size(), 0u);
+
+    // Rows of the appended column follow existing ones.
+    arr->Append(slice);
+    ASSERT_EQ(arr->Size(), 6u);
+    ASSERT_EQ(arr->GetAsColumn(5)->Size(), 2u);
+    ASSERT_EQ(arr->GetAsColumn(5)->As<ColumnString>()->At(0), strings[1]);
+    ASSERT_EQ(arr->GetAsColumn(3)->As<ColumnString>()->At(0), strings[3]);
+}
+
 TEST(ColumnsCase, DateAppend) {
     auto col1 = std::make_shared<ColumnDate>();
     auto col2 = std::make_shared<ColumnDate>();
@@ -164,6 +567,55 @@ TEST(ColumnsCase, NullableSlice) {
     ASSERT_EQ(subData->At(3), 17u);
 }
 
+TEST(ColumnsCase, LoadAfterClear) {
+    // Columns of received blocks are cleared and loaded again when
+    // they are reused by the next block.
+    for (const std::string type : {"Tuple(UInt64, String)", "Array(UInt64)", "Nullable(String)"}) {
+        auto reused = CreateColumnByType(type);
+        ASSERT_TRUE(reused) << type;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            // Column of one row, saved by a column of the same type.
+            auto source = CreateColumnByType(type);
+            if (auto tuple = source->As<ColumnTuple>()) {
+                (*tuple)[0]->As<ColumnUInt64>()->Append(pass);
+                (*tuple)[1]->As<ColumnString>()->Append(std::to_string(pass));
+            } else if (auto array = source->As<ColumnArray>()) {
+                auto items = std::make_shared<ColumnUInt64>();
+                items->Append(pass);
+                array->AppendAsColumn(items);
+            } else if (auto nullable = source->As<ColumnNullable>()) {
+                nullable->Nested()->As<ColumnString>()->Append(std::to_string(pass));
+                nullable->Nulls()->As<ColumnUInt8>()->Append(0);
+            }
+
+            Buffer data;
+            {
+                BufferOutput output(&data);
+                CodedOutputStream coded(&output);
+                source->Save(&coded);
+            }
+
+            reused->Clear();
+            ASSERT_EQ(reused->Size(), 0u) << type;
+
+            ArrayInput input(data.data(), data.size());
+            CodedInputStream coded(&input);
+            ASSERT_TRUE(reused->Load(&coded, 1)) << type;
+            ASSERT_EQ(reused->Size(), 1u) << type;
+
+            if (auto tuple = reused->As<ColumnTuple>()) {
+                ASSERT_EQ((*tuple)[0]->As<ColumnUInt64>()->At(0), uint64_t(pass));
+                ASSERT_EQ((*tuple)[1]->As<ColumnString>()->At(0), std::to_string(pass));
+            } else if (auto array = reused->As<ColumnArray>()) {
+                ASSERT_EQ(array->GetAsColumn(0)->As<ColumnUInt64>()->At(0), uint64_t(pass));
+            } else if (auto nullable = reused->As<ColumnNullable>()) {
+                ASSERT_EQ(nullable->Nested()->As<ColumnString>()->At(0), std::to_string(pass));
+            }
+        }
+    }
+}
+
 TEST(ColumnsCase, UUIDInit) {
     auto col = std::make_shared<ColumnUUID>(std::make_shared<ColumnUInt64>(MakeUUIDs()));
 
@@ -0,0 +1,525 @@
+#include "fake_server.h"
+
+#include <clickhouse/base/coded.h>
+#include <clickhouse/base/compressed.h>
+#include <clickhouse/base/socket.h>
+#include <clickhouse/base/wire_format.h>
+#include <clickhouse/columns/array.h>
+#include <clickhouse/columns/date.h>
+#include <clickhouse/columns/factory.h>
+#include <clickhouse/columns/nullable.h>
+#include <clickhouse/columns/numeric.h>
+#include <clickhouse/columns/string.h>
+#include <clickhouse/protocol.h>
+#include <clickhouse/query.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define REVISION 54401
+
+namespace clickhouse {
+namespace {
+
+template <typename T>
+bool FillNumbers(const ColumnRef& col, size_t rows) {
+    if (auto numbers = col->As<ColumnVector<T>>()) {
+        for (size_t i = 0; i < rows; ++i) {
+            numbers->Append(static_cast<T>(i));
+        }
+        return true;
+    }
+    return false;
+}
+
+void FillColumn(const ColumnRef& col, size_t rows) {
+    if (FillNumbers<int8_t>(col, rows) || FillNumbers<int16_t>(col, rows) ||
+        FillNumbers<int32_t>(col, rows) || FillNumbers<int64_t>(col, rows) ||
+        FillNumbers<uint8_t>(col, rows) || FillNumbers<uint16_t>(col, rows) ||
+        FillNumbers<uint32_t>(col, rows) || FillNumbers<uint64_t>(col, rows) ||
+        FillNumbers<float>(col, rows) || FillNumbers<double>(col, rows))
+    {
+        return;
+    }
+
+    if (auto strings = col->As<ColumnString>()) {
+        for (size_t i = 0; i < rows; ++i) {
+            strings->Append("value " + std::to_string(i));
+        }
+    } else if (auto strings = col->As<ColumnFixedString>()) {
+        for (size_t i = 0; i < rows; ++i) {
+            strings->Append(std::to_string(i));
+        }
+    } else if (auto dates = col->As<ColumnDate>()) {
+        for (size_t i = 0; i < rows; ++i) {
+            dates->Append(static_cast<std::time_t>(i * 86400));
+        }
+    } else if (auto dates = col->As<ColumnDateTime>()) {
+        for (size_t i = 0; i < rows; ++i) {
+            dates->Append(static_cast<std::time_t>(i));
+        }
+    } else if (auto nullable = col->As<ColumnNullable>()) {
+        auto nulls = nullable->Nulls()->As<ColumnUInt8>();
+
+        FillColumn(nullable->Nested(), rows);
+        for (size_t i = 0; i < rows; ++i) {
+            nulls->Append(i % 3 == 0);
+        }
+    } else if (auto array = col->As<ColumnArray>()) {
+        // Arrays have from zero to three elements.
+        auto items = CreateColumnByType(array->Type()->GetItemType()->GetName());
+        size_t offset = 0;
+
+        FillColumn(items, rows / 4 * 6 + 6);
+        for (size_t i = 0; i < rows; ++i) {
+            array->AppendAsColumn(items->Slice(offset, i % 4));
+            offset += i % 4;
+        }
+    } else {
+        throw std::runtime_error("can't make values of type " + col->Type()->GetName());
+    }
+}
+
+}
+
+ColumnRef MakeSyntheticColumn(const std::string& type, size_t rows) {
+    ColumnRef col = CreateColumnByType(type);
+
+    if (!col) {
+        throw std::runtime_error("unsupported column type: " + type);
+    }
+    FillColumn(col, rows);
+
+    return col;
+}
+
+Block MakeSyntheticBlock(const std::vector<std::string>& types, size_t rows) {
+    Block block;
+
+    for (size_t i = 0; i < types.size(); ++i) {
+        block.AppendColumn("c" + std::to_string(i), MakeSyntheticColumn(types[i], rows));
+    }
+
+    return block;
+}
+
+
+/**
+ * Streams of a connection and the protocol state negotiated by the client.
+ */
+class FakeServer::Connection {
+public:
+    explicit Connection(int s)
+        : socket_input_(s)
+        , buffered_input_(&socket_input_)
+        , input_(&buffered_input_)
+        , socket_output_(s)
+        , buffered_output_(&socket_output_)
+        , output_(&buffered_output_)
+    {
+    }
+
+    CodedInputStream* Input() {
+        return &input_;
+    }
+
+    CodedOutputStream* Output() {
+        return &output_;
+    }
+
+    void ReceiveHello() {
+        uint64_t packet_type;
+        uint64_t num;
+        std::string value;
+
+        if (!input_.ReadVarint64(&packet_type) || packet_type != ClientCodes::Hello) {
+            throw std::runtime_error("expected hello");
+        }
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadString(&input_, &value);
+    }
+
+    void SendHello() {
+        WireFormat::WriteUInt64(&output_, ServerCodes::Hello);
+        WireFormat::WriteString(&output_, "ClickHouse");
+        WireFormat::WriteUInt64(&output_, 1);
+        WireFormat::WriteUInt64(&output_, 1);
+        WireFormat::WriteUInt64(&output_, REVISION);
+        WireFormat::WriteString(&output_, "UTC");
+        WireFormat::WriteString(&output_, "fake");
+        WireFormat::WriteUInt64(&output_, 1);
+        output_.Flush();
+    }
+
+    /// Reads the query packet, which follows its packet type.
+    std::string ReceiveQuery(std::map<std::string, std::string>* settings) {
+        std::string value;
+        std::string query;
+        uint64_t num;
+        uint8_t byte;
+
+        // Query id.
+        WireFormat::ReadString(&input_, &value);
+
+        // Client info.
+        WireFormat::ReadFixed(&input_, &byte);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadFixed(&input_, &byte);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadString(&input_, &value);
+        WireFormat::ReadUInt64(&input_, &num);
+
+        // Settings end with an empty name.  Like the server, the type of
+        // a setting is known by its name.
+        method_ = CompressionMethodByte::LZ4;
+        settings->clear();
+        while (WireFormat::ReadString(&input_, &value) && !value.empty()) {
+            const std::string name = value;
+
+            if (QuerySettings::TypeOf(name) == QuerySettings::Type::String) {
+                WireFormat::ReadString(&input_, &value);
+            } else {
+                WireFormat::ReadUInt64(&input_, &num);
+                value = std::to_string(num);
+            }
+            if (name == "network_compression_method" && value == "ZSTD") {
+                method_ = CompressionMethodByte::ZSTD;
+            }
+            (*settings)[name] = value;
+        }
+
+        // Stage and compression.
+        WireFormat::ReadUInt64(&input_, &num);
+        WireFormat::ReadUInt64(&input_, &num);
+        compression_ = (num == CompressionState::Enable);
+
+        if (!WireFormat::ReadString(&input_, &query)) {
+            throw std::runtime_error("can't read query");
+        }
+
+        return query;
+    }
+
+    /// Reads a Data packet and returns count of rows of the block.
+    uint64_t ReceiveData() {
+        uint64_t packet_type;
+        std::string table_name;
+
+        if (!input_.ReadVarint64(&packet_type) || packet_type != ClientCodes::Data) {
+            throw std::runtime_error("expected data");
+        }
+        WireFormat::ReadString(&input_, &table_name);
+
+        if (compression_) {
+            CompressedInput compressed(&input_);
+            CodedInputStream coded(&compressed);
+
+            return ReadBlock(&coded);
+        }
+
+        return ReadBlock(&input_);
+    }
+
+    void SendData(const Block& block) {
+        WireFormat::WriteUInt64(&output_, ServerCodes::Data);
+        WireFormat::WriteString(&output_, std::string());
+
+        if (compression_) {
+            CompressedOutput compressed(&buffered_output_, method_);
+            CodedOutputStream coded(&compressed);
+
+            WriteBlock(block, &coded);
+            compressed.Flush();
+        } else {
+            WriteBlock(block, &output_);
+        }
+    }
+
+    void SendProgress(uint64_t rows) {
+        WireFormat::WriteUInt64(&output_, ServerCodes::Progress);
+        WireFormat::WriteUInt64(&output_, rows);
+        WireFormat::WriteUInt64(&output_, 0);
+        WireFormat::WriteUInt64(&output_, 0);
+    }
+
+    void SendProfile(uint64_t rows, uint64_t blocks, uint64_t bytes) {
+        WireFormat::WriteUInt64(&output_, ServerCodes::ProfileInfo);
+        WireFormat::WriteUInt64(&output_, rows);
+        WireFormat::WriteUInt64(&output_, blocks);
+        WireFormat::WriteUInt64(&output_, bytes);
+        WireFormat::WriteFixed(&output_, false);
+        WireFormat::WriteUInt64(&output_, 0);
+        WireFormat::WriteFixed(&output_, false);
+    }
+
+    void SendException(const std::string& text) {
+        WireFormat::WriteUInt64(&output_, ServerCodes::Exception);
+        WireFormat::WriteFixed(&output_, int32_t(1000));
+        WireFormat::WriteString(&output_, "DB::Exception");
+        WireFormat::WriteString(&output_, text);
+        WireFormat::WriteString(&output_, std::string());
+        WireFormat::WriteFixed(&output_, false);
+        output_.Flush();
+    }
+
+    void SendEndOfStream() {
+        WireFormat::WriteUInt64(&output_, ServerCodes::EndOfStream);
+        output_.Flush();
+    }
+
+private:
+    static uint64_t ReadBlock(CodedInputStream* input) {
+        uint64_t num;
+        uint8_t is_overflows;
+        int32_t bucket_num;
+        uint64_t num_columns = 0;
+        uint64_t num_rows = 0;
+
+        // Block info.
+        WireFormat::ReadUInt64(input, &num);
+        WireFormat::ReadFixed(input, &is_overflows);
+        WireFormat::ReadUInt64(input, &num);
+        WireFormat::ReadFixed(input, &bucket_num);
+        WireFormat::ReadUInt64(input, &num);
+
+        if (!WireFormat::ReadUInt64(input, &num_columns) ||
+            !WireFormat::ReadUInt64(input, &num_rows))
+        {
+            throw std::runtime_error("can't read block");
+        }
+
+        for (size_t i = 0; i < num_columns; ++i) {
+            std::string name;
+            std::string type;
+
+            WireFormat::ReadString(input, &name);
+            WireFormat::ReadString(input, &type);
+
+            ColumnRef col = CreateColumnByType(type);
+            if (!col) {
+                throw std::runtime_error("unsupported column type: " + type);
+            }
+            if (num_rows && !col->Load(input, num_rows)) {
+                throw std::runtime_error("can't load column " + name);
+            }
+        }
+
+        return num_rows;
+    }
+
+    static void WriteBlock(const Block& block, CodedOutputStream* output) {
+        WireFormat::WriteUInt64(output, 1);
+        WireFormat::WriteFixed (output, block.Info().is_overflows);
+        WireFormat::WriteUInt64(output, 2);
+        WireFormat::WriteFixed (output, block.Info().bucket_num);
+        WireFormat::WriteUInt64(output, 0);
+
+        WireFormat::WriteUInt64(output, block.GetColumnCount());
+        WireFormat::WriteUInt64(output, block.GetRowCount());
+
+        for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+            WireFormat::WriteString(output, bi.Name());
+            WireFormat::WriteString(output, bi.Type()->GetName());
+
+            bi.Column()->Save(output);
+        }
+    }
+
+private:
+    SocketInput socket_input_;
+    BufferedInput buffered_input_;
+    CodedInputStream input_;
+    SocketOutput socket_output_;
+    BufferedOutput buffered_output_;
+    CodedOutputStream output_;
+
+    bool compression_ = false;
+    int method_ = CompressionMethodByte::LZ4;
+};
+
+
+FakeServer::FakeServer(int port)
+    : server_(port)
+{
+    server_.start();
+    thread_ = std::thread([this] { Serve(); });
+}
+
+FakeServer::~FakeServer() {
+    server_.stop();
+    thread_.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int s : sessions_) {
+            shutdown(s, SHUT_RDWR);
+        }
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void FakeServer::SetScript(const FakeServerScript& script) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    script_ = script;
+}
+
+uint64_t FakeServer::InsertedRows() const {
+    return inserted_rows_;
+}
+
+std::string FakeServer::LastQuery() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_query_;
+}
+
+std::map<std::string, std::string> FakeServer::LastSettings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_settings_;
+}
+
+void FakeServer::Serve() {
+    int s;
+
+    while ((s = server_.accept()) >= 0) {
+        // Like the real server, send small packets without delay.
+        int nodelay = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        sessions_.push_back(s);
+        threads_.emplace_back([this, s] {
+            try {
+                Session(s);
+            } catch (const std::exception&) {
+                // The connection has been closed or is broken.
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            sessions_.erase(std::find(sessions_.begin(), sessions_.end(), s));
+            close(s);
+        });
+    }
+}
+
+void FakeServer::Session(int s) {
+    Connection connection(s);
+    uint64_t packet_type;
+
+    connection.ReceiveHello();
+    connection.SendHello();
+
+    while (connection.Input()->ReadVarint64(&packet_type)) {
+        FakeServerScript script;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            script = script_;
+        }
+
+        switch (packet_type) {
+        case ClientCodes::Ping:
+            std::this_thread::sleep_for(script.latency);
+            WireFormat::WriteUInt64(connection.Output(), ServerCodes::Pong);
+            connection.Output()->Flush();
+            break;
+
+        case ClientCodes::Cancel:
+            // The whole response has already been sent.
+            break;
+
+        case ClientCodes::Query: {
+            std::map<std::string, std::string> settings;
+            const std::string query = connection.ReceiveQuery(&settings);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last_query_ = query;
+                last_settings_ = std::move(settings);
+            }
+
+            // Skip the empty block which ends external data.
+            connection.ReceiveData();
+            std::this_thread::sleep_for(script.latency);
+
+            if (query.compare(0, 6, "INSERT") == 0) {
+                // Structure of the table, then rows until an empty block.
+                connection.SendData(Block());
+                connection.Output()->Flush();
+
+                while (const uint64_t rows = connection.ReceiveData()) {
+                    inserted_rows_ += rows;
+                }
+                connection.SendEndOfStream();
+            } else if (!Respond(&connection, script)) {
+                return;
+            }
+            break;
+        }
+
+        default:
+            throw std::runtime_error("unexpected packet " + std::to_string(packet_type));
+        }
+    }
+}
+
+bool FakeServer::Respond(Connection* connection, const FakeServerScript& script) {
+    const bool fault = !script.error.empty() || script.disconnect;
+    const auto start = std::chrono::steady_clock::now();
+    Block block = script.block;
+    size_t sent = 0;
+
+    for (size_t i = 0; i < script.blocks; ++i) {
+        if (fault && i == script.fault_after) {
+            break;
+        }
+        if (i > 0) {
+            std::this_thread::sleep_until(start + i * script.interval);
+        }
+        if (script.progress) {
+            connection->SendProgress(block.GetRowCount());
+        }
+        if (script.buckets) {
+            BlockInfo info;
+            info.bucket_num = int32_t(i);
+            block.SetInfo(info);
+        }
+        connection->SendData(block);
+        connection->Output()->Flush();
+        ++sent;
+    }
+
+    if (script.profile) {
+        connection->SendProfile(sent * block.GetRowCount(), sent, 0);
+    }
+
+    if (script.disconnect) {
+        return false;
+    }
+    if (!script.error.empty()) {
+        // The exception ends the response.
+        connection->SendException(script.error);
+    } else {
+        connection->SendEndOfStream();
+    }
+
+    return true;
+}
+
+}
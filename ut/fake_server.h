@@ -0,0 +1,102 @@
+#pragma once
+
+#include "tcp_server.h"
+
+#include <clickhouse/block.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace clickhouse {
+
+/// Creates a column of the given type filled with \p rows of synthetic
+/// values.  Supports numbers, strings, dates and Nullable or Array of them.
+ColumnRef MakeSyntheticColumn(const std::string& type, size_t rows);
+
+/// Creates a block with a synthetic column of each of the given types.
+Block MakeSyntheticBlock(const std::vector<std::string>& types, size_t rows);
+
+/**
+ * Describes how FakeServer answers queries.
+ */
+struct FakeServerScript {
+    /// Block sent in response to SELECT queries.
+    Block block;
+    /// Count of copies of the block in the response.
+    size_t blocks = 0;
+
+    /// Delay before the response to any query or ping.
+    std::chrono::microseconds latency{0};
+    /// Minimal interval between blocks, which limits the rate of the stream.
+    std::chrono::microseconds interval{0};
+    /// Send a Progress packet before every block.
+    bool progress = false;
+    /// Number copies of the block as buckets of two-level aggregation.
+    bool buckets = false;
+    /// Send a ProfileInfo packet before the end of the response.
+    bool profile = false;
+
+    /// If not empty, an exception with this text is sent after
+    /// \p fault_after blocks instead of the rest of the response.
+    std::string error;
+    /// Close the connection after \p fault_after blocks.
+    bool disconnect = false;
+    size_t fault_after = 0;
+};
+
+/**
+ * A local stand-in for ClickHouse server, which speaks enough of the native
+ * protocol to serve Ping, Select and Insert, with or without compression.
+ * Responses to SELECT queries follow the script, rows of INSERT queries
+ * are loaded and counted.  Every connection is served by its own thread.
+ */
+class FakeServer {
+public:
+    explicit FakeServer(int port);
+    ~FakeServer();
+
+    /// Sets the script for subsequent queries.
+    void SetScript(const FakeServerScript& script);
+
+    /// Count of rows received with INSERT queries.
+    uint64_t InsertedRows() const;
+
+    /// Text of the last received query.
+    std::string LastQuery() const;
+
+    /// Settings of the last received query.  Numeric values are converted
+    /// to strings.
+    std::map<std::string, std::string> LastSettings() const;
+
+private:
+    class Connection;
+
+    void Serve();
+
+    /// Handles packets of a connection until the client closes it.
+    void Session(int s);
+
+    /// Sends the response to a SELECT query according to the script.
+    /// Returns false if the connection must be closed.
+    bool Respond(Connection* connection, const FakeServerScript& script);
+
+private:
+    LocalTcpServer server_;
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    /// Sockets of open connections.
+    std::vector<int> sessions_;
+    std::vector<std::thread> threads_;
+    FakeServerScript script_;
+    std::string last_query_;
+    std::map<std::string, std::string> last_settings_;
+
+    std::atomic<uint64_t> inserted_rows_{0};
+};
+
+}
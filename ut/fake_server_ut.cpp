@@ -0,0 +1,424 @@
+#include "fake_server.h"
+
+#include <clickhouse/async_client.h>
+#include <clickhouse/client.h>
+#include <contrib/gtest/gtest.h>
+
+using namespace clickhouse;
+
+static const int kPort = 19200;
+
+// Run the same tests against the local server with different compression
+// of data.
+class FakeServerCase : public testing::TestWithParam<CompressionMethod> {
+protected:
+    void SetUp() override {
+        server_.reset(new FakeServer(kPort));
+        client_.reset(new Client(ClientOptions()
+            .SetHost("localhost")
+            .SetPort(kPort)
+            .SetCompressionMethod(GetParam())
+            .SetSettings(QuerySettings()
+                .Set("max_block_size", 10000)
+                .Set("max_threads", 8))));
+    }
+
+    void TearDown() override {
+        client_.reset();
+        server_.reset();
+    }
+
+    std::unique_ptr<FakeServer> server_;
+    std::unique_ptr<Client> client_;
+};
+
+TEST_P(FakeServerCase, Select) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64", "String", "Array(Nullable(UInt8))"}, 1000);
+    script.blocks = 5;
+    server_->SetScript(script);
+
+    size_t blocks = 0;
+    client_->Select("SELECT c0, c1, c2 FROM fake", [&blocks](const Block& block) {
+        ASSERT_EQ(block.GetColumnCount(), 3u);
+        ASSERT_EQ(block.GetRowCount(), 1000u);
+        ASSERT_EQ(block[0]->As<ColumnUInt64>()->At(999), 999u);
+        ASSERT_EQ(block[1]->As<ColumnString>()->At(7), "value 7");
+        ASSERT_EQ(block[2]->Type()->GetName(), "Array(Nullable(UInt8))");
+        ++blocks;
+    });
+
+    ASSERT_EQ(blocks, 5u);
+    ASSERT_EQ(server_->LastQuery(), "SELECT c0, c1, c2 FROM fake");
+}
+
+TEST_P(FakeServerCase, Insert) {
+    client_->Insert("fake", MakeSyntheticBlock({"UInt32", "String"}, 300));
+    client_->Insert("fake", MakeSyntheticBlock({"Nullable(String)"}, 200));
+
+    ASSERT_EQ(server_->InsertedRows(), 500u);
+    ASSERT_EQ(server_->LastQuery(), "INSERT INTO fake ( c0 ) VALUES");
+}
+
+TEST_P(FakeServerCase, BrokenInsert) {
+    const Block block = MakeSyntheticBlock({"UInt64"}, 65536);
+
+    client_->BeginInsert("fake", {"c0"});
+    server_.reset();
+
+    ASSERT_ANY_THROW({
+        for (size_t i = 0; i < 1000; ++i) {
+            client_->InsertData(block);
+        }
+    });
+
+    // The failed insert is over, so the next one reports the network
+    // error instead of an insert in progress.
+    try {
+        client_->Insert("fake", block);
+        FAIL() << "exception expected";
+    } catch (const std::logic_error& e) {
+        FAIL() << e.what();
+    } catch (const std::exception&) {
+    }
+}
+
+TEST_P(FakeServerCase, ProgressAndLatency) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt8"}, 10);
+    script.blocks = 3;
+    script.latency = std::chrono::milliseconds(20);
+    script.interval = std::chrono::milliseconds(10);
+    script.progress = true;
+    server_->SetScript(script);
+
+    uint64_t progress_rows = 0;
+    size_t rows = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    client_->Select(Query("SELECT c0 FROM fake")
+        .OnProgress([&progress_rows](const Progress& progress) {
+            progress_rows += progress.rows;
+        })
+        .OnData([&rows](const Block& block) {
+            rows += block.GetRowCount();
+        })
+    );
+
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+    ASSERT_EQ(progress_rows, 30u);
+    ASSERT_EQ(rows, 30u);
+}
+
+TEST_P(FakeServerCase, Exception) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64"}, 10);
+    script.blocks = 3;
+    script.error = "injected error";
+    script.fault_after = 1;
+    server_->SetScript(script);
+
+    size_t blocks = 0;
+    try {
+        client_->Select("SELECT c0 FROM fake", [&blocks](const Block&) { ++blocks; });
+        FAIL() << "exception expected";
+    } catch (const ServerException& e) {
+        ASSERT_EQ(e.GetException().display_text, "injected error");
+    }
+    ASSERT_EQ(blocks, 1u);
+
+    // The connection is still usable.
+    script.error.clear();
+    server_->SetScript(script);
+
+    client_->Select("SELECT c0 FROM fake", [&blocks](const Block&) { ++blocks; });
+    ASSERT_EQ(blocks, 4u);
+}
+
+TEST_P(FakeServerCase, Disconnect) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64"}, 10);
+    script.blocks = 3;
+    script.disconnect = true;
+    script.fault_after = 2;
+    server_->SetScript(script);
+
+    ASSERT_ANY_THROW(client_->Select("SELECT c0 FROM fake", [](const Block&) {}));
+
+    script.disconnect = false;
+    server_->SetScript(script);
+
+    size_t blocks = 0;
+    client_->ResetConnection();
+    client_->Select("SELECT c0 FROM fake", [&blocks](const Block&) { ++blocks; });
+    ASSERT_EQ(blocks, 3u);
+}
+
+TEST_P(FakeServerCase, Stats) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64", "String"}, 1000);
+    script.blocks = 4;
+    server_->SetScript(script);
+
+    QueryStats stats;
+    size_t calls = 0;
+
+    client_->Select(Query("SELECT c0, c1 FROM fake")
+        .OnStats([&] (const QueryStats& s) {
+            stats = s;
+            ++calls;
+        })
+    );
+
+    ASSERT_EQ(calls, 1u);
+    ASSERT_EQ(stats.blocks, 4u);
+    ASSERT_EQ(stats.rows, 4000u);
+    ASSERT_GT(stats.bytes_sent, 0u);
+    ASSERT_GT(stats.bytes_received, 0u);
+    ASSERT_GT(stats.socket_reads, 0u);
+    ASSERT_GT(stats.socket_writes, 0u);
+    ASSERT_GT(stats.allocations, 0u);
+    ASSERT_GT(stats.allocated_bytes, stats.rows * sizeof(uint64_t));
+    if (GetParam() == CompressionMethod::None) {
+        ASSERT_EQ(stats.compressed_bytes, 0u);
+        ASSERT_EQ(stats.uncompressed_bytes, 0u);
+    } else {
+        ASSERT_GT(stats.compressed_bytes, 0u);
+        ASSERT_GE(stats.bytes_received, stats.compressed_bytes);
+        ASSERT_GT(stats.uncompressed_bytes, stats.rows * sizeof(uint64_t));
+        ASSERT_GT(stats.decompress_time.count(), 0);
+    }
+    ASSERT_GE(stats.total_time, stats.read_time + stats.decompress_time + stats.load_time);
+
+    // Statistics are delivered for a failed query too.
+    script.error = "injected error";
+    script.fault_after = 2;
+    server_->SetScript(script);
+    calls = 0;
+
+    ASSERT_THROW(client_->Select(Query("SELECT c0, c1 FROM fake")
+        .OnStats([&] (const QueryStats& s) {
+            stats = s;
+            ++calls;
+        })
+    ), ServerException);
+    ASSERT_EQ(calls, 1u);
+    ASSERT_EQ(stats.rows, 2000u);
+}
+
+TEST_P(FakeServerCase, StatsColumnsOutliveClient) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64", "String"}, 1000);
+    script.blocks = 2;
+    server_->SetScript(script);
+
+    // A query without a handler of statistics between the measured ones
+    // does not add to them.
+    std::vector<Block> blocks;
+    QueryStats stats;
+    auto select = [&] () {
+        client_->Select(Query("SELECT c0, c1 FROM fake")
+            .OnData([&blocks] (const Block& block) { blocks.push_back(block); })
+            .OnStats([&stats] (const QueryStats& s) { stats = s; }));
+    };
+
+    select();
+    const QueryStats first = stats;
+    client_->Select("SELECT c0, c1 FROM fake", [] (const Block&) { });
+    select();
+
+    ASSERT_EQ(stats.rows, first.rows);
+    ASSERT_EQ(stats.allocations, first.allocations);
+    ASSERT_EQ(stats.allocated_bytes, first.allocated_bytes);
+
+    // Columns allocated through the counting resource are freed after
+    // the client has gone.
+    client_.reset();
+    ASSERT_EQ(blocks.size(), 4u);
+    ASSERT_EQ(blocks.back()[1]->As<ColumnString>()->At(999), "value 999");
+    blocks.clear();
+}
+
+TEST_P(FakeServerCase, AsyncSelect) {
+    // Blocks are large enough to be received by many reads.
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock(
+        {"UInt64", "String", "Array(Nullable(UInt8))", "FixedString(8)"}, 100000);
+    script.blocks = 3;
+    script.progress = true;
+    server_->SetScript(script);
+
+    auto select = [] (QueryStats* stats, size_t* memory_calls, size_t* rows) {
+        return Query("SELECT c0, c1, c2, c3 FROM fake")
+            .OnData([rows] (const Block& block) {
+                ASSERT_EQ(block.GetColumnCount(), 4u);
+                ASSERT_EQ(block[0]->As<ColumnUInt64>()->At(99999), 99999u);
+                ASSERT_EQ(block[1]->As<ColumnString>()->At(99999), "value 99999");
+                *rows += block.GetRowCount();
+            })
+            .OnColumnMemory([memory_calls] (const std::string&, TypeRef, size_t, size_t) {
+                ++*memory_calls;
+                return nullptr;
+            })
+            .OnStats([stats] (const QueryStats& s) {
+                *stats = s;
+            });
+    };
+
+    QueryStats expected;
+    size_t expected_calls = 0;
+    size_t rows = 0;
+    client_->Select(select(&expected, &expected_calls, &rows));
+
+    AsyncClient async(ClientOptions()
+        .SetHost("localhost")
+        .SetPort(kPort)
+        .SetCompressionMethod(GetParam()));
+
+    QueryStats stats;
+    size_t calls = 0;
+    rows = 0;
+    async.Execute(select(&stats, &calls, &rows)).get();
+
+    // Blocks are received by many reads.  Columns of a fixed width are
+    // loaded once all their rows have been received, so memory for them is
+    // requested once; other columns may be loaded again from the beginning.
+    ASSERT_EQ(rows, 300000u);
+    ASSERT_GT(stats.socket_reads, stats.blocks);
+    ASSERT_EQ(stats.blocks, expected.blocks);
+    ASSERT_EQ(calls, expected_calls);
+    ASSERT_GE(stats.allocations, expected.allocations);
+    ASSERT_EQ(stats.uncompressed_bytes, expected.uncompressed_bytes);
+}
+
+TEST_P(FakeServerCase, AsyncInsertAndReconnect) {
+    AsyncClient async(ClientOptions()
+        .SetHost("localhost")
+        .SetPort(kPort)
+        .SetCompressionMethod(GetParam()), 2);
+
+    // Blocks larger than buffers of the socket are sent by parts,
+    // whenever the socket becomes writable.
+    const Block block = MakeSyntheticBlock({"UInt64", "String"}, 1000000);
+    std::vector<std::future<void>> results;
+
+    for (int i = 0; i < 4; ++i) {
+        results.push_back(async.Insert("fake", block));
+    }
+    for (auto& r : results) {
+        r.get();
+    }
+    ASSERT_EQ(server_->InsertedRows(), 4000000u);
+
+    // Broken connections are reset before the next query.
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64"}, 100);
+    script.blocks = 2;
+    script.disconnect = true;
+    script.fault_after = 1;
+    server_->SetScript(script);
+
+    results.clear();
+    for (int i = 0; i < 2; ++i) {
+        results.push_back(async.Select("SELECT c0 FROM fake", [](const Block&) {}));
+    }
+    for (auto& r : results) {
+        ASSERT_ANY_THROW(r.get());
+    }
+
+    script.disconnect = false;
+    server_->SetScript(script);
+
+    size_t rows = 0;
+    async.Select("SELECT c0 FROM fake", [&rows](const Block& b) { rows += b.GetRowCount(); }).get();
+    ASSERT_EQ(rows, 200u);
+}
+
+TEST_P(FakeServerCase, BlockInfoAndProfile) {
+    FakeServerScript script;
+    script.block = MakeSyntheticBlock({"UInt64"}, 100);
+    script.blocks = 4;
+    script.buckets = true;
+    script.profile = true;
+    server_->SetScript(script);
+
+    // Rows of every bucket of two-level aggregation are merged separately.
+    std::vector<uint64_t> sums(script.blocks);
+    Profile profile;
+
+    client_->Select(Query("SELECT c0 FROM fake")
+        .OnData([&sums] (const Block& block) {
+            if (block.GetRowCount() == 0) {
+                return;
+            }
+            ASSERT_GE(block.Info().bucket_num, 0);
+            ASSERT_EQ(block.Info().is_overflows, 0u);
+            for (size_t i = 0; i < block.GetRowCount(); ++i) {
+                sums.at(block.Info().bucket_num) += (*block[0]->As<ColumnUInt64>())[i];
+            }
+        })
+        .OnProfile([&profile] (const Profile& p) {
+            profile = p;
+        })
+    );
+
+    ASSERT_EQ(sums, std::vector<uint64_t>(4, 100 * 99 / 2));
+    ASSERT_EQ(profile.rows, 400u);
+    ASSERT_EQ(profile.blocks, 4u);
+
+    // Blocks received one by one carry their info too.
+    Block block;
+    std::vector<int32_t> buckets;
+
+    client_->BeginSelect(Query("SELECT c0 FROM fake"));
+    while (client_->ReceiveBlock(&block)) {
+        buckets.push_back(block.Info().bucket_num);
+    }
+    ASSERT_EQ(buckets, std::vector<int32_t>({0, 1, 2, 3}));
+}
+
+TEST_P(FakeServerCase, Settings) {
+    client_->Select(Query("SELECT c0 FROM fake")
+        .SetSetting("max_threads", 2)
+        .SetSetting("extremes", true)
+        .SetSetting("load_balancing", "in_order"));
+
+    std::map<std::string, std::string> expected = {
+        {"extremes", "1"},
+        {"load_balancing", "in_order"},
+        {"max_block_size", "10000"},
+        {"max_threads", "2"},
+    };
+    if (GetParam() == CompressionMethod::ZSTD) {
+        expected["network_compression_method"] = "ZSTD";
+    }
+    ASSERT_EQ(server_->LastSettings(), expected);
+
+    // Settings of the client are sent with inserts too.
+    client_->Insert("fake", MakeSyntheticBlock({"UInt8"}, 1));
+    ASSERT_EQ(server_->LastSettings().at("max_threads"), "8");
+
+    // A setting of the query overrides the compression method.
+    client_->Select(Query("SELECT c0 FROM fake")
+        .SetSetting("network_compression_method", "LZ4"));
+    ASSERT_EQ(server_->LastSettings().at("network_compression_method"), "LZ4");
+
+    // A value of the wrong type would break the stream, so it is rejected.
+    ASSERT_THROW(Query("").SetSetting("max_threads", "8"), std::logic_error);
+    ASSERT_THROW(Query("").SetSetting("load_balancing", 1), std::logic_error);
+
+    // Settings unknown to the client keep the type they are set with.
+    const QuerySettings unknown = QuerySettings()
+        .Set("some_new_string_setting", "value")
+        .Set("some_new_number_setting", 1);
+    ASSERT_EQ(std::get<std::string>(*unknown.Get("some_new_string_setting")), "value");
+    ASSERT_EQ(std::get<uint64_t>(*unknown.Get("some_new_number_setting")), 1u);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Local, FakeServerCase,
+    ::testing::Values(
+        CompressionMethod::None,
+        CompressionMethod::LZ4,
+        CompressionMethod::ZSTD
+    ));
@@ -3,6 +3,7 @@
 #include <clickhouse/base/socket.h>
 #include <contrib/gtest/gtest.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdio.h>
 #include <string.h>
@@ -30,3 +31,35 @@ TEST(Socketcase, connecterror) {
       ASSERT_NE(EINPROGRESS,e.code().value());
    }
 }
+
+TEST(Socketcase, gatherwrite) {
+   int fds[2];
+   ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+   SocketHolder writer(fds[0]);
+   SocketHolder reader(fds[1]);
+
+   // Larger than the kernel buffer, so sendmsg() returns partial writes.
+   std::vector<uint8_t> data(4 << 20);
+   for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = uint8_t(i * 13);
+   }
+
+   std::vector<uint8_t> received(data.size());
+   std::thread thread([&] {
+      SocketInput input(reader);
+      size_t pos = 0;
+      while (pos < received.size()) {
+         pos += input.Read(received.data() + pos, received.size() - pos);
+      }
+   });
+
+   std::vector<OutputSlice> slices;
+   for (size_t pos = 0; pos < data.size(); pos += (1 << 20) - 1) {
+      slices.push_back({ data.data() + pos, std::min<size_t>((1 << 20) - 1, data.size() - pos) });
+   }
+   SocketOutput output(writer);
+   output.WriteV(slices.data(), slices.size());
+
+   thread.join();
+   ASSERT_TRUE(received == data);
+}
@@ -1,6 +1,13 @@
 #include <clickhouse/base/coded.h>
+#include <clickhouse/base/compressed.h>
 #include <contrib/gtest/gtest.h>
 
+#include <lz4/lz4.h>
+#include <zstd/zstd.h>
+
+#include <algorithm>
+#include <stdexcept>
+
 using namespace clickhouse;
 
 TEST(CodedStreamCase, Varint64) {
@@ -21,3 +28,331 @@ TEST(CodedStreamCase, Varint64) {
         ASSERT_EQ(value, 18446744071965638648ULL);
     }
 }
+
+/// Returns data of the underlying stream by small pieces.
+class ChunkedInput : public InputStream {
+public:
+    ChunkedInput(const Buffer& data, size_t chunk)
+        : data_(data)
+        , chunk_(chunk)
+    {
+    }
+
+protected:
+    size_t DoRead(void* buf, size_t len) override {
+        len = std::min({len, chunk_, data_.size() - pos_});
+        memcpy(buf, data_.data() + pos_, len);
+        pos_ += len;
+        ++reads_;
+        return len;
+    }
+
+public:
+    /// Count of calls of Read().
+    size_t reads_ = 0;
+
+private:
+    const Buffer& data_;
+    const size_t chunk_;
+    size_t pos_ = 0;
+};
+
+TEST(BufferedStreamCase, AdaptiveGrowth) {
+    Buffer data(1 << 20);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i % 251);
+    }
+
+    for (size_t max_buflen : {0, 64 << 10}) {
+        ChunkedInput chunked(data, data.size());
+        BufferedInput input(&chunked, 1024, max_buflen);
+        CodedInputStream coded(&input);
+
+        Buffer result(data.size());
+        for (size_t pos = 0; pos < result.size(); pos += 100) {
+            const size_t len = std::min<size_t>(100, result.size() - pos);
+            ASSERT_TRUE(coded.ReadRaw(result.data() + pos, len));
+        }
+        EXPECT_TRUE(result == data);
+
+        if (max_buflen) {
+            EXPECT_LT(chunked.reads_, 64U);
+        } else {
+            EXPECT_EQ(chunked.reads_, 1024U);
+        }
+    }
+}
+
+/// Records every call of Write() and WriteV() of the stream.
+class RecordingOutput : public OutputStream {
+protected:
+    void DoWrite(const void* data, size_t len) override {
+        const OutputSlice slice = { data, len };
+        DoWriteV(&slice, 1);
+    }
+
+    void DoWriteV(const OutputSlice* slices, size_t count) override {
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* p = static_cast<const uint8_t*>(slices[i].data);
+            data_.insert(data_.end(), p, p + slices[i].len);
+        }
+        ++writes_;
+    }
+
+public:
+    Buffer data_;
+    /// Count of calls which reached the stream.
+    size_t writes_ = 0;
+};
+
+TEST(BufferedStreamCase, GatherLargeWrites) {
+    Buffer payload(5000);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = uint8_t(i * 7);
+    }
+
+    RecordingOutput slave;
+    {
+        BufferedOutput output(&slave, 1024);
+
+        output.Write("header", 6);
+        EXPECT_EQ(0U, slave.writes_);
+
+        // Buffered header and both slices go out in one call.
+        const OutputSlice slices[] = {
+            { payload.data(), 16 },
+            { payload.data() + 16, payload.size() - 16 },
+        };
+        output.WriteV(slices, 2);
+        EXPECT_EQ(1U, slave.writes_);
+
+        // Small writes are still buffered.
+        output.Write("tail", 4);
+        output.Write(payload.data(), 2000);
+        EXPECT_EQ(2U, slave.writes_);
+    }
+    EXPECT_EQ(2U, slave.writes_);
+
+    Buffer expected;
+    expected.insert(expected.end(), (const uint8_t*)"header", (const uint8_t*)"header" + 6);
+    expected.insert(expected.end(), payload.begin(), payload.end());
+    expected.insert(expected.end(), (const uint8_t*)"tail", (const uint8_t*)"tail" + 4);
+    expected.insert(expected.end(), payload.begin(), payload.begin() + 2000);
+    EXPECT_TRUE(slave.data_ == expected);
+}
+
+TEST(CodedStreamCase, Varint64Boundaries) {
+    std::vector<uint64_t> values;
+    for (size_t bits = 0; bits <= 64; ++bits) {
+        const uint64_t value = (bits == 64) ? ~0ULL : (1ULL << bits);
+        values.push_back(value);
+        values.push_back(value - 1);
+        values.push_back(value + 1);
+    }
+
+    Buffer buf;
+    {
+        BufferOutput output(&buf);
+        CodedOutputStream coded(&output);
+        for (auto value : values) {
+            coded.WriteVarint64(value);
+        }
+        // Padding, so the last values are not at the end of the data.
+        coded.WriteRaw("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", 10);
+    }
+
+    // Values are split between refills of the buffer at different offsets.
+    for (size_t chunk : {1, 3, 7, 8, 11, 64}) {
+        ChunkedInput chunked(buf, chunk);
+        BufferedInput input(&chunked, chunk);
+        CodedInputStream coded(&input);
+
+        for (auto expected : values) {
+            uint64_t value;
+            ASSERT_TRUE(coded.ReadVarint64(&value));
+            ASSERT_EQ(expected, value);
+        }
+
+        uint8_t padding[10];
+        ASSERT_TRUE(coded.ReadRaw(padding, sizeof(padding)));
+        EXPECT_FALSE(coded.ReadRaw(padding, 1));
+
+        uint64_t value;
+        EXPECT_FALSE(coded.ReadVarint64(&value));
+    }
+}
+
+TEST(CodedStreamCase, Varint64Encoding) {
+    const std::vector<std::pair<uint64_t, std::vector<uint8_t>>> cases = {
+        {0, {0x00}},
+        {127, {0x7F}},
+        {128, {0x80, 0x01}},
+        {(1ULL << 56) - 1, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F}},
+        {1ULL << 56, {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01}},
+        {1ULL << 63, {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01}},
+        {~0ULL, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01}},
+    };
+
+    for (const auto& c : cases) {
+        uint8_t bytes[CodedInputStream::MAX_VARINT_BYTES];
+        const size_t size = CodedOutputStream::EncodeVarint(c.first, bytes);
+        ASSERT_EQ(std::vector<uint8_t>(bytes, bytes + size), c.second);
+
+        // Decoding of exactly the value and of the value followed by other
+        // data, which takes the wide path where it is available.
+        std::vector<uint8_t> padded(c.second);
+        padded.resize(16, 0xFF);
+        for (const auto& data : {c.second, padded}) {
+            uint64_t value = 1;
+            ASSERT_EQ(CodedInputStream::DecodeVarint(data.data(), data.size(), &value), size);
+            ASSERT_EQ(value, c.first);
+        }
+
+        // A truncated value is not decoded.
+        uint64_t value;
+        ASSERT_EQ(CodedInputStream::DecodeVarint(c.second.data(), size - 1, &value), 0u);
+    }
+}
+
+/// Appends a compressed frame of \p data in the native format to \p buf.
+static void AppendFrame(const Buffer& data, Buffer* buf, uint8_t method = 0x82) {
+    Buffer frame;
+    if (method == 0x82) {
+        frame.resize(9 + LZ4_compressBound(data.size()));
+        const int size = LZ4_compress((const char*)data.data(), (char*)frame.data() + 9, data.size());
+        frame.resize(9 + size);
+    } else {
+        frame.resize(9 + ZSTD_compressBound(data.size()));
+        const size_t size = ZSTD_compress(frame.data() + 9, frame.size() - 9, data.data(), data.size(), 1);
+        frame.resize(9 + size);
+    }
+
+    uint8_t* p = frame.data();
+    WriteUnaligned(p, method); p += 1;
+    WriteUnaligned(p, (uint32_t)frame.size()); p += 4;
+    WriteUnaligned(p, (uint32_t)data.size());
+
+    const uint128 hash = CityHash128((const char*)frame.data(), frame.size());
+
+    buf->insert(buf->end(), (const uint8_t*)&hash, (const uint8_t*)(&hash + 1));
+    buf->insert(buf->end(), frame.begin(), frame.end());
+}
+
+/// Poorly compressible content of the test stream.
+static uint8_t ByteAt(uint64_t i) {
+    i *= 0x9E3779B97F4A7C15ULL;
+    i ^= i >> 29;
+    i *= 0xBF58476D1CE4E5B9ULL;
+    return uint8_t(i >> 32);
+}
+
+static Buffer MakeFrames(size_t count, size_t frame_size) {
+    Buffer buf;
+    for (size_t i = 0; i < count; ++i) {
+        Buffer data(frame_size);
+        for (size_t j = 0; j < data.size(); ++j) {
+            data[j] = ByteAt(i * frame_size + j);
+        }
+        AppendFrame(data, &buf);
+    }
+    return buf;
+}
+
+TEST(CompressedStreamCase, ReadFrames) {
+    const Buffer buf = MakeFrames(8, 1 << 20);
+
+    ArrayInput input(buf.data(), buf.size());
+    CodedInputStream coded(&input);
+    CompressedInput compressed(&coded);
+    CodedInputStream decompressed(&compressed);
+
+    Buffer result(8 << 20);
+    ASSERT_TRUE(decompressed.ReadRaw(result.data(), result.size()));
+    for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(ByteAt(i), result[i]);
+    }
+
+    EXPECT_TRUE(input.Exhausted());
+}
+
+TEST(CompressedStreamCase, Corrupted) {
+    Buffer buf = MakeFrames(1, 1 << 20);
+    buf[buf.size() / 2] ^= 0xFF;
+
+    ArrayInput input(buf.data(), buf.size());
+    CodedInputStream coded(&input);
+    CompressedInput compressed(&coded);
+
+    uint8_t byte;
+    EXPECT_THROW(compressed.ReadByte(&byte), std::runtime_error);
+}
+
+TEST(CompressedStreamCase, Zstd) {
+    Buffer buf;
+    for (size_t i = 0; i < 4; ++i) {
+        // Compressible content mixed with noise.
+        Buffer data(1 << 16);
+        for (size_t j = 0; j < data.size(); ++j) {
+            data[j] = (j % 3) ? uint8_t(j / 1000) : ByteAt(j);
+        }
+        AppendFrame(data, &buf, 0x90);
+    }
+
+    ArrayInput input(buf.data(), buf.size());
+    CodedInputStream coded(&input);
+    CompressedInput compressed(&coded);
+    CodedInputStream decompressed(&compressed);
+
+    for (size_t i = 0; i < 4; ++i) {
+        Buffer result(1 << 16);
+        ASSERT_TRUE(decompressed.ReadRaw(result.data(), result.size()));
+        for (size_t j = 0; j < result.size(); ++j) {
+            ASSERT_EQ((j % 3) ? uint8_t(j / 1000) : ByteAt(j), result[j]);
+        }
+    }
+    EXPECT_TRUE(input.Exhausted());
+}
+
+TEST(CompressedStreamCase, WriteFrames) {
+    const size_t kSize = (7 << 19) + 123;
+    Buffer data(kSize);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (i % 5) ? uint8_t(i / 100) : ByteAt(i);
+    }
+
+    for (int method : {CompressionMethodByte::LZ4, CompressionMethodByte::ZSTD}) {
+        Buffer buf;
+        {
+            BufferOutput output(&buf);
+            CompressedOutput compressed(&output, method, 3);
+            // Mix small and large writes.
+            compressed.Write(data.data(), 100);
+            compressed.Write(data.data() + 100, (1 << 20) - 100);
+            compressed.Write(data.data() + (1 << 20), (2 << 20) + 1);
+            compressed.Write(data.data() + (3 << 20) + 1, kSize - (3 << 20) - 1);
+            compressed.Flush();
+        }
+
+        // Every frame holds at most 1MB of data.
+        size_t frames = 0;
+        for (size_t pos = 0; pos < buf.size(); ++frames) {
+            uint32_t compressed, original;
+            memcpy(&compressed, buf.data() + pos + 17, sizeof(compressed));
+            memcpy(&original, buf.data() + pos + 21, sizeof(original));
+            EXPECT_EQ(method, buf[pos + 16]);
+            EXPECT_LE(original, 1U << 20);
+            pos += 16 + compressed;
+        }
+        EXPECT_EQ(4U, frames);
+
+        ArrayInput input(buf.data(), buf.size());
+        CodedInputStream coded(&input);
+        CompressedInput compressed(&coded);
+        CodedInputStream decompressed(&compressed);
+
+        Buffer result(kSize);
+        ASSERT_TRUE(decompressed.ReadRaw(result.data(), result.size()));
+        EXPECT_TRUE(result == data);
+        EXPECT_TRUE(input.Exhausted());
+    }
+}
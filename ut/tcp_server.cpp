@@ -45,6 +45,13 @@ void LocalTcpServer::start() {
     listen(serverSd_, 3);
 }
 
+int LocalTcpServer::accept() {
+    if (serverSd_ < 0) {
+        return -1;
+    }
+    return ::accept(serverSd_, nullptr, nullptr);
+}
+
 void LocalTcpServer::stop() {
     if(serverSd_ > 0) {
         shutdown(serverSd_, SHUT_RDWR);
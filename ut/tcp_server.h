@@ -10,6 +10,10 @@ public:
     void start();
     void stop();
 
+    /// Waits for an incoming connection and returns its socket,
+    /// or -1 if the server has been stopped.
+    int accept();
+
 private:
     void startImpl();
 
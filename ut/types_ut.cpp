@@ -74,3 +74,42 @@ TEST(TypesCase, EnumTypes) {
     ASSERT_EQ((*(++enum16.BeginValueToName())).first, 2);
     ASSERT_EQ((*(++enum16.BeginValueToName())).second, "Red");
 }
+
+TEST(TypesCase, SharedTypes) {
+    // Types without parameters have a single instance.
+    ASSERT_EQ(Type::CreateSimple<int32_t>(), Type::CreateSimple<int32_t>());
+    ASSERT_EQ(Type::CreateString(), Type::CreateString());
+    ASSERT_EQ(
+        Type::CreateArray(Type::CreateSimple<uint64_t>()),
+        Type::CreateArray(Type::CreateSimple<uint64_t>())
+    );
+    ASSERT_EQ(
+        Type::CreateNullable(Type::CreateString())->GetNestedType(),
+        Type::CreateString()
+    );
+    ASSERT_NE(Type::CreateSimple<int32_t>(), Type::CreateSimple<uint32_t>());
+}
+
+TEST(TypesCase, IsEqual) {
+    ASSERT_TRUE(Type::CreateString(4)->IsEqual(Type::CreateString(4)));
+    ASSERT_FALSE(Type::CreateString(4)->IsEqual(Type::CreateString(5)));
+    ASSERT_FALSE(Type::CreateString()->IsEqual(Type::CreateString(5)));
+
+    ASSERT_TRUE(Type::CreateDateTime("UTC")->IsEqual(Type::CreateDateTime("UTC")));
+    ASSERT_FALSE(Type::CreateDateTime("UTC")->IsEqual(Type::CreateDateTime()));
+    ASSERT_FALSE(Type::CreateDateTime64(3)->IsEqual(Type::CreateDateTime64(6)));
+    ASSERT_FALSE(Type::CreateDecimal(18, 2)->IsEqual(Type::CreateDecimal(18, 3)));
+
+    auto tuple = [] (TypeRef item) {
+        return Type::CreateTuple({
+            Type::CreateArray(Type::CreateNullable(item)),
+            Type::CreateString()});
+    };
+    ASSERT_TRUE(tuple(Type::CreateString(8))->IsEqual(tuple(Type::CreateString(8))));
+    ASSERT_FALSE(tuple(Type::CreateString(8))->IsEqual(tuple(Type::CreateString(9))));
+    ASSERT_FALSE(tuple(Type::CreateString())->IsEqual(Type::CreateTuple({Type::CreateString()})));
+
+    ASSERT_TRUE(Type::CreateEnum8({{"One", 1}})->IsEqual(Type::CreateEnum8({{"One", 1}})));
+    ASSERT_FALSE(Type::CreateEnum8({{"One", 1}})->IsEqual(Type::CreateEnum8({{"Two", 1}})));
+    ASSERT_FALSE(Type::CreateEnum8({{"One", 1}})->IsEqual(Type::CreateEnum16({{"One", 1}})));
+}